@@ -18,16 +18,24 @@
 
 #include "stdafx.h"
 #include "mlMainWindow.h"
+#include "mlCommandLine.h"
 
 int main(int argc, char* argv[])
 {
-	QApplication app(argc, argv);
-
 	QCoreApplication::setOrganizationDomain("treyarch.com");
 	QCoreApplication::setOrganizationName("Treyarch");
 	QCoreApplication::setApplicationName("ModLauncher");
 	//QCoreApplication::setApplicationVersion();
 
+	// Headless builds don't need any of the GUI, so they only get a core application
+	if (mlCommandLine::IsHeadless(argc, argv))
+	{
+		QCoreApplication app(argc, argv);
+		return mlCommandLine::Exec(QCoreApplication::arguments());
+	}
+
+	QApplication app(argc, argv);
+
 	mlMainWindow mainWindow;
 	mainWindow.UpdateDB();
 	mainWindow.show();
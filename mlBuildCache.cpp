@@ -0,0 +1,317 @@
+#include "stdafx.h"
+
+QSharedPointer<mlBuildCacheMemo::mlEntry> mlBuildCacheMemo::Entry(const QString& FilePath)
+{
+	QMutexLocker locker(&mMutex);
+
+	auto& entry = mEntries[FilePath];
+	if (entry.isNull())
+	{
+		entry.reset(new mlEntry);
+		entry->Size = -1;
+		entry->Time = -1;
+	}
+
+	return entry;
+}
+
+QString mlBuildCacheMemo::Hash(const QString& FilePath, qint64 Size, qint64 Time)
+{
+	const auto entry = Entry(FilePath);
+	QMutexLocker locker(&entry->Mutex);
+
+	if (entry->Size != Size || entry->Time != Time)
+	{
+		entry->Hash = mlBuildCache::HashFile(FilePath).toHex();
+		entry->Size = Size;
+		entry->Time = Time;
+	}
+
+	return entry->Hash;
+}
+
+QJsonArray mlBuildCacheMemo::References(const QString& FilePath, const QString& Hash, const QStringList& Roots)
+{
+	const auto entry = Entry(FilePath);
+	QMutexLocker locker(&entry->Mutex);
+
+	if (entry->ReferencesHash != Hash)
+	{
+		entry->References.clear();
+		entry->ReferencesHash = Hash;
+	}
+
+	const auto rootsKey = Roots.join('\n');
+	if (!entry->References.contains(rootsKey))
+		entry->References[rootsKey] = QJsonArray::fromStringList(mlBuildCache::FindReferences(FilePath, Roots));
+
+	return entry->References[rootsKey];
+}
+
+QJsonObject mlBuildCache::Fingerprint(const QList<mlBuildInput>& Inputs, const QStringList& Excludes, const QJsonObject& Previous,
+                                      const std::atomic<bool>* Cancel, mlBuildCacheMemo* Memo)
+{
+	mlBuildCacheMemo localMemo;
+	auto& memo = Memo != nullptr ? *Memo : localMemo;
+
+	const auto previousFiles = Previous["Files"].toObject();
+	const auto previousReferences = Previous["References"].toObject();
+	auto files = QJsonObject{};
+	auto references = QJsonObject{};
+
+	auto excludes = QStringList{};
+	for (const auto& exclude : Excludes)
+		excludes.append(QDir::cleanPath(exclude) + '/');
+
+	auto addFile = [&](const QFileInfo& FileInfo, const QStringList& ReferenceRoots)
+	{
+		const auto filePath = QDir::cleanPath(FileInfo.absoluteFilePath());
+		for (const auto& exclude : excludes)
+		{
+			if (filePath.startsWith(exclude, Qt::CaseInsensitive))
+				return;
+		}
+
+		const auto size = FileInfo.size();
+		const auto time = FileInfo.lastModified().toMSecsSinceEpoch();
+		const auto previous = previousFiles[filePath].toArray();
+
+		auto hash = QString{};
+		if (previous.count() == 3 && previous[0].toDouble() == size && previous[1].toDouble() == time)
+			hash = previous[2].toString();
+		else
+			hash = memo.Hash(filePath, size, time);
+
+		files[filePath] = QJsonArray{static_cast<double>(size), static_cast<double>(time), hash};
+
+		// A file is only scanned again when its contents changed
+		if (ReferenceRoots.isEmpty())
+			return;
+
+		if (previousReferences.contains(filePath) && previous.count() == 3 && previous[2].toString() == hash)
+			references[filePath] = previousReferences[filePath];
+		else
+			references[filePath] = memo.References(filePath, hash, ReferenceRoots);
+	};
+
+	for (const auto& input : Inputs)
+	{
+		const auto fileInfo = QFileInfo{input.Path};
+		if (fileInfo.isFile())
+		{
+			addFile(fileInfo, input.ReferenceRoots);
+		}
+		else if (fileInfo.isDir())
+		{
+			QDirIterator it(input.Path, input.NameFilters, QDir::Files, QDirIterator::Subdirectories);
+			while (it.hasNext() && (Cancel == nullptr || !*Cancel))
+			{
+				it.next();
+				addFile(it.fileInfo(), input.ReferenceRoots);
+			}
+		}
+	}
+
+	// Referenced files that don't exist are still listed, so they invalidate the fingerprint once they're created
+	for (auto it = references.begin(); it != references.end() && (Cancel == nullptr || !*Cancel); ++it)
+	{
+		for (const auto& reference : it.value().toArray())
+		{
+			const auto fileInfo = QFileInfo{reference.toString()};
+			if (!files.contains(fileInfo.filePath()) && fileInfo.isFile())
+				addFile(fileInfo, QStringList());
+		}
+	}
+
+	auto fingerprint = QJsonObject{};
+	fingerprint["Files"] = files;
+	if (!references.isEmpty())
+		fingerprint["References"] = references;
+	return fingerprint;
+}
+
+bool mlBuildCache::Matches(const QJsonObject& Fingerprint, const QJsonObject& Previous)
+{
+	// References only change along with the files they were found in
+	for (auto it = Fingerprint.begin(); it != Fingerprint.end(); ++it)
+	{
+		if (it.key() != "Files" && it.key() != "References" && Previous[it.key()] != it.value())
+			return false;
+	}
+
+	const auto files = Fingerprint["Files"].toObject();
+	const auto previousFiles = Previous["Files"].toObject();
+
+	if (Previous.count() != Fingerprint.count() || files.count() != previousFiles.count())
+		return false;
+
+	for (auto it = files.begin(); it != files.end(); ++it)
+	{
+		const auto file = it.value().toArray();
+		const auto previous = previousFiles[it.key()].toArray();
+
+		if (previous.count() != 3 || previous[0] != file[0] || previous[2] != file[2])
+			return false;
+	}
+
+	return true;
+}
+
+QString mlBuildCache::Differences(const QJsonObject& Fingerprint, const QJsonObject& Previous)
+{
+	if (Previous.isEmpty())
+		return "nothing was recorded yet";
+
+	for (auto it = Fingerprint.begin(); it != Fingerprint.end(); ++it)
+	{
+		if (it.key() != "Files" && it.key() != "References" && Previous[it.key()] != it.value())
+			return QString("%1 changed").arg(it.key().toLower());
+	}
+
+	const auto files = Fingerprint["Files"].toObject();
+	const auto previousFiles = Previous["Files"].toObject();
+
+	auto changed = QStringList{};
+	auto added = QStringList{};
+	auto removed = QStringList{};
+
+	for (auto it = files.begin(); it != files.end(); ++it)
+	{
+		const auto file = it.value().toArray();
+		const auto previous = previousFiles[it.key()].toArray();
+
+		if (previous.isEmpty())
+			added.append(it.key());
+		else if (previous.count() != 3 || previous[0] != file[0] || previous[2] != file[2])
+			changed.append(it.key());
+	}
+
+	for (auto it = previousFiles.begin(); it != previousFiles.end(); ++it)
+	{
+		if (!files.contains(it.key()))
+			removed.append(it.key());
+	}
+
+	auto reasons = QStringList{};
+	auto describe = [&](const QStringList& Files, const char* What)
+	{
+		if (Files.count() == 1)
+			reasons.append(QString("'%1' %2").arg(QFileInfo(Files[0]).fileName(), What));
+		else if (Files.count() > 1)
+			reasons.append(QString("%1 files %2").arg(Files.count()).arg(What));
+	};
+
+	describe(changed, "changed");
+	describe(added, "added");
+	describe(removed, "removed");
+
+	return reasons.isEmpty() ? "outputs are missing" : reasons.join(", ");
+}
+
+QJsonObject mlBuildCache::Load(const QString& Manifest)
+{
+	auto file = QFile{Manifest};
+	if (!file.open(QIODevice::ReadOnly))
+		return QJsonObject{};
+
+	return QJsonDocument::fromJson(file.readAll()).object();
+}
+
+bool mlBuildCache::Save(const QString& Manifest, const QJsonObject& Fingerprint)
+{
+	if (!QDir{}.mkpath(QFileInfo(Manifest).absolutePath()))
+		return false;
+
+	auto file = QSaveFile{Manifest};
+	if (!file.open(QIODevice::WriteOnly))
+		return false;
+
+	file.write(QJsonDocument(Fingerprint).toJson(QJsonDocument::Compact));
+	return file.commit();
+}
+
+QByteArray mlBuildCache::HashFile(const QString& FilePath)
+{
+	auto file = QFile{FilePath};
+	if (!file.open(QIODevice::ReadOnly))
+		return QByteArray{};
+
+	auto hash = QCryptographicHash{QCryptographicHash::Md5};
+	hash.addData(&file);
+	return hash.result();
+}
+
+QStringList mlBuildCache::FindReferences(const QString& FilePath, const QStringList& Roots)
+{
+	auto file = QFile{FilePath};
+	if (Roots.isEmpty() || !file.open(QIODevice::ReadOnly))
+		return QStringList{};
+
+	const auto data = file.readAll();
+	auto references = QStringList{};
+	auto found = QSet<QString>{};
+
+	auto isPath = [](const QByteArray& Token)
+	{
+		if (Token.size() < 3 || Token.size() >= 260)
+			return false;
+
+		// A file extension starts with a letter, which rules out numbers such as "0.5"
+		const auto extensionIdx = Token.lastIndexOf('.') + 1;
+		if (extensionIdx <= 1 || extensionIdx >= Token.size() || Token.size() - extensionIdx > 16)
+			return false;
+
+		if (!isalpha(static_cast<unsigned char>(Token[extensionIdx])))
+			return false;
+
+		for (auto charIdx = extensionIdx; charIdx < Token.size(); charIdx++)
+		{
+			if (!isalnum(static_cast<unsigned char>(Token[charIdx])) && Token[charIdx] != '_')
+				return false;
+		}
+
+		return true;
+	};
+
+	// GDT values are quoted and zone entries are separated by commas, paths are the tokens with a file extension
+	auto tokenStart = 0;
+	for (auto charIdx = 0; charIdx <= data.size(); charIdx++)
+	{
+		const auto c = charIdx < data.size() ? data[charIdx] : '\n';
+		if (c != '"' && c != ',' && c != ' ' && c != '\t' && c != '\r' && c != '\n')
+			continue;
+
+		const auto token = data.mid(tokenStart, charIdx - tokenStart);
+		tokenStart = charIdx + 1;
+
+		if (!isPath(token))
+			continue;
+
+		// GDTs escape their backslashes, cleanPath() merges the doubled separators
+		const auto path = QDir::cleanPath(QString::fromUtf8(token).replace('\\', '/'));
+		if (found.contains(path.toLower()))
+			continue;
+		found.insert(path.toLower());
+
+		if (QDir::isAbsolutePath(path))
+		{
+			references.append(path);
+			continue;
+		}
+
+		auto reference = QDir::cleanPath(Roots[0] + '/' + path);
+		for (const auto& root : Roots)
+		{
+			const auto candidate = QDir::cleanPath(root + '/' + path);
+			if (QFileInfo(candidate).isFile())
+			{
+				reference = candidate;
+				break;
+			}
+		}
+
+		references.append(reference);
+	}
+
+	return references;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+struct mlBuildInput
+{
+	QString Path;
+	QStringList NameFilters; // Only used when Path is a folder, an empty list matches every file
+
+	// When set, the files are scanned for paths to other files, which are inputs as well. Relative paths are looked up
+	// in these folders, in order.
+	QStringList ReferenceRoots;
+};
+
+// Hashes and references found while fingerprinting, shared by the steps of one build so a file that's an input of
+// several steps, like the GDTs every zone links against, is only read once even when the steps check at the same time
+class mlBuildCacheMemo
+{
+public:
+	QString Hash(const QString& FilePath, qint64 Size, qint64 Time);
+	QJsonArray References(const QString& FilePath, const QString& Hash, const QStringList& Roots);
+
+protected:
+	struct mlEntry
+	{
+		QMutex Mutex; // Held while the file is read, a second step asking for the same file waits for the result
+		qint64 Size;
+		qint64 Time;
+		QString Hash;
+		QString ReferencesHash;
+		QHash<QString, QJsonArray> References; // By the roots they were looked up in
+	};
+
+	QSharedPointer<mlEntry> Entry(const QString& FilePath);
+
+	QMutex mMutex;
+	QHash<QString, QSharedPointer<mlEntry>> mEntries;
+};
+
+// A fingerprint records the size, modification time and content hash of every input file. Hashes are only computed
+// for files whose size or modification time changed since the previous fingerprint, and only the size and hash are
+// compared so touching a file without changing it doesn't invalidate anything.
+class mlBuildCache
+{
+public:
+	static QJsonObject Fingerprint(const QList<mlBuildInput>& Inputs, const QStringList& Excludes, const QJsonObject& Previous,
+	                               const std::atomic<bool>* Cancel = nullptr, mlBuildCacheMemo* Memo = nullptr);
+	static bool Matches(const QJsonObject& Fingerprint, const QJsonObject& Previous);
+	static QString Differences(const QJsonObject& Fingerprint, const QJsonObject& Previous);
+
+	static QJsonObject Load(const QString& Manifest);
+	static bool Save(const QString& Manifest, const QJsonObject& Fingerprint);
+
+	static QByteArray HashFile(const QString& FilePath);
+
+	// Paths in GDT values or zone entries, the first existing match in Roots for each, or the first candidate if there's none
+	static QStringList FindReferences(const QString& FilePath, const QStringList& Roots);
+};
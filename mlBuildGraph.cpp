@@ -0,0 +1,286 @@
+#include "stdafx.h"
+
+#include <iterator>
+
+const char* gLanguages[] = {
+	"english", "french", "italian", "spanish", "german", "portuguese", "russian", "polish", "japanese",
+	"traditionalchinese", "simplifiedchinese", "englisharabic"
+};
+
+mlBuildGraph mlBuildGraph::Create(const mlBuildOptions& Options)
+{
+	auto graph = mlBuildGraph{};
+	auto updateStep = -1;
+
+	const auto& gamePath = Options.GamePath;
+	const auto& toolsPath = Options.ToolsPath;
+
+	auto addUpdateDbCommand = [&]() -> int
+	{
+		if (updateStep == -1)
+		{
+			updateStep = graph.AddUpdateDBStep(gamePath, toolsPath);
+		}
+
+		return updateStep;
+	};
+
+	// Links are skipped when the zone, its folder, the GDTs, the files either of them point to, the arguments and the
+	// linker itself didn't change. Assets the zone only names, like sound alias files, aren't followed.
+	auto addLinkCache = [&](int Step, const QString& RootFolder, const QString& ZoneName, const QString& ManifestName,
+	                        const QList<mlBuildInput>& ExtraInputs)
+	{
+		const auto rootFolder = QDir::cleanPath(RootFolder);
+		const auto cacheFolder = rootFolder + "/.modlauncher";
+
+		// GDTs point at exported models, animations and textures, zones at raw files in the folder or in share/raw
+		const auto assetRoots = QStringList() << QDir::cleanPath(gamePath) << QDir::cleanPath(gamePath + "/model_export")
+		                                      << QDir::cleanPath(gamePath + "/xanim_export") << QDir::cleanPath(gamePath + "/sound_assets");
+		const auto zoneRoots = QStringList() << rootFolder << QDir::cleanPath(gamePath + "/share/raw");
+
+		auto inputs = QList<mlBuildInput>{};
+		inputs << mlBuildInput{rootFolder, QStringList()};
+		inputs << mlBuildInput{rootFolder + "/zone_source", QStringList() << ZoneName + ".zone", zoneRoots};
+		inputs << mlBuildInput{QDir::cleanPath(gamePath + "/source_data"), QStringList() << "*.gdt", assetRoots};
+		inputs << mlBuildInput{QDir::cleanPath(toolsPath + "/bin/linker_modtools.exe"), QStringList()};
+		inputs << ExtraInputs;
+
+		graph.SetCache(Step, QString("%1/%2.link").arg(cacheFolder, ManifestName), inputs,
+		               QStringList() << rootFolder + "/zone" << cacheFolder,
+		               QStringList() << QString("%1/zone/%2.ff").arg(rootFolder, ZoneName));
+	};
+
+	auto lastMap = QString{};
+	auto lastMod = QString{};
+
+	// Every shard is a separate linker run, the languages are dealt out so each shard gets the same number of them
+	auto languageShards = QList<QStringList>{};
+
+	if (Options.Language.compare("All", Qt::CaseInsensitive) != 0)
+	{
+		languageShards << (QStringList() << "-language" << Options.Language);
+	}
+	else
+	{
+		const auto shardCount = qBound(1, Options.LinkShards, static_cast<int>(std::size(gLanguages)));
+		for (auto shardIdx = 0; shardIdx < shardCount; shardIdx++)
+			languageShards << QStringList();
+
+		auto languageIdx = 0;
+		for (const auto& language : gLanguages)
+		{
+			languageShards[languageIdx++ % shardCount] << "-language" << language;
+		}
+
+		graph.SetPoolLimit("link shards", Options.LinkShardJobs);
+	}
+
+	auto addLinkSteps = [&](const QString& Target, const QStringList& Arguments, int Dependency, const QString& RootFolder,
+	                        const QString& ZoneName, const QList<mlBuildInput>& ExtraInputs)
+	{
+		const auto linker = QString("%1/bin/linker_modtools.exe").arg(toolsPath);
+
+		if (languageShards.count() == 1)
+		{
+			const auto linkStep = graph.AddStep(Target, "link", linker, QStringList() << languageShards[0] << Arguments,
+			                                    QList<int>() << Dependency);
+			addLinkCache(linkStep, RootFolder, ZoneName, ZoneName, ExtraInputs);
+			return;
+		}
+
+		auto shardSteps = QList<int>{};
+		for (auto shardIdx = 0; shardIdx < languageShards.count(); shardIdx++)
+		{
+			const auto shardStep = graph.AddStep(Target, QString("link %1/%2").arg(shardIdx + 1).arg(languageShards.count()), linker,
+			                                     QStringList() << languageShards[shardIdx] << Arguments, QList<int>() << Dependency);
+			graph.SetPool(shardStep, "link shards");
+			addLinkCache(shardStep, RootFolder, ZoneName, QString("%1.%2").arg(ZoneName).arg(shardIdx + 1), ExtraInputs);
+			shardSteps << shardStep;
+		}
+
+		graph.AddMergeStep(Target, "link", shardSteps);
+	};
+
+	for (const auto& mapName : Options.Maps)
+	{
+		auto previousStep = -1;
+
+		if (Options.Compile)
+		{
+			previousStep = addUpdateDbCommand();
+
+			auto args = QStringList{};
+			args << "-platform" << "pc";
+
+			if (Options.CompileEntsOnly)
+			{
+				args << "-onlyents";
+			}
+			else
+			{
+				args << "-navmesh" << "-navvolume";
+			}
+
+			args << "-loadFrom" << QString(R"(%1\map_source\%2\%3.map)").arg(gamePath, mapName.left(2), mapName);
+			args << QString(R"(%1\share\raw\maps\%2\%3.d3dbsp)").arg(gamePath, mapName.left(2), mapName);
+
+			previousStep = graph.AddStep(mapName, "compile", QString("%1\\bin\\cod2map64.exe").arg(toolsPath), args,
+			                             QList<int>() << previousStep);
+		}
+
+		if (Options.Light)
+		{
+			if (previousStep == -1)
+				previousStep = addUpdateDbCommand();
+
+			auto args = QStringList{};
+			args << "-ledSilent";
+
+			switch (Options.LightQuality)
+			{
+			case 0:
+				args << "+low";
+				break;
+
+			default:
+			case 1:
+				args << "+medium";
+				break;
+
+			case 2:
+				args << "+high";
+				break;
+			}
+
+			args << "+localprobes" << "+forceclean" << "+recompute" << QString("%1/map_source/%2/%3.map").arg(gamePath, mapName.left(2), mapName);
+			previousStep = graph.AddStep(mapName, "light", QString("%1/bin/radiant_modtools.exe").arg(toolsPath), args,
+			                             QList<int>() << previousStep);
+		}
+
+		if (Options.Link)
+		{
+			if (previousStep == -1)
+				previousStep = addUpdateDbCommand();
+
+			// The compiled and lit map is linked from share/raw
+			addLinkSteps(mapName, QStringList() << "-modsource" << mapName, previousStep,
+			             QString("%1/usermaps/%2").arg(gamePath, mapName), mapName, QList<mlBuildInput>()
+			             << mlBuildInput{QDir::cleanPath(QString("%1/share/raw/maps/%2").arg(gamePath, mapName.left(2))),
+			                             QStringList() << mapName + ".*"});
+		}
+
+		lastMap = mapName;
+	}
+
+	for (const auto& modZone : Options.ModZones)
+	{
+		const auto& modName = modZone.first;
+
+		if (Options.Link)
+		{
+			const auto dependency = addUpdateDbCommand();
+
+			const auto& zoneName = modZone.second;
+			addLinkSteps(modName + "/" + zoneName, QStringList() << "-fs_game" << modName << "-modsource" << zoneName, dependency,
+			             QString("%1/mods/%2").arg(gamePath, modName), zoneName, QList<mlBuildInput>());
+		}
+
+		lastMod = modName;
+	}
+
+	if (Options.Run && (!lastMod.isEmpty() || !lastMap.isEmpty()))
+	{
+		auto args = QStringList{};
+
+		if (!Options.RunDvars.isEmpty())
+		{
+			args << Options.RunDvars;
+		}
+
+		args << "+set" << "fs_game" << (lastMod.isEmpty() ? lastMap : lastMod);
+
+		if (!lastMap.isEmpty())
+		{
+			args << "+devmap" << lastMap;
+		}
+
+		if (!Options.RunOptions.isEmpty())
+		{
+			args << Options.RunOptions.split(' ');
+		}
+
+		// The game waits for everything else, with "Ignore Errors" checked it still launches after a failed step
+		graph.AddStep(QString(), "BlackOps3", QString("%1BlackOps3.exe").arg(gamePath), args, graph.AllSteps(), true);
+	}
+
+	return graph;
+}
+
+int mlBuildGraph::AddUpdateDBStep(const QString& GamePath, const QString& ToolsPath)
+{
+	const auto step = AddStep(QString(), "gdtdb", QString("%1/gdtdb/gdtdb.exe").arg(ToolsPath), QStringList() << "/update");
+
+	// The GDT journal records every GDT as it was the last time gdtdb succeeded, nothing to update if none of them changed
+	const auto journal = QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation) + "/gdtdb.journal";
+	auto inputs = QList<mlBuildInput>{};
+	inputs << mlBuildInput{QDir::cleanPath(GamePath + "/source_data"), QStringList() << "*.gdt"};
+	inputs << mlBuildInput{QDir::cleanPath(ToolsPath + "/gdtdb/gdtdb.exe"), QStringList()};
+
+	SetCache(step, journal, inputs, QStringList(), QStringList());
+	return step;
+}
+
+int mlBuildGraph::AddStep(const QString& Target, const QString& Action, const QString& Program,
+                          const QStringList& Arguments, const QList<int>& Dependencies, bool RunAfterFailure)
+{
+	auto step = mlBuildStep{};
+	step.Name = Target.isEmpty() ? Action : QString("%1 %2").arg(Target, Action);
+	step.Target = Target;
+	step.Program = Program;
+	step.Arguments = Arguments;
+	step.RunAfterFailure = RunAfterFailure;
+
+	for (auto dependency : Dependencies)
+	{
+		Q_ASSERT(dependency >= 0 && dependency < mSteps.count());
+		if (dependency >= 0 && !step.Dependencies.contains(dependency))
+			step.Dependencies.append(dependency);
+	}
+
+	mSteps.append(step);
+	return mSteps.count() - 1;
+}
+
+int mlBuildGraph::AddMergeStep(const QString& Target, const QString& Action, const QList<int>& Parts)
+{
+	return AddStep(Target, Action, QString(), QStringList(), Parts, true);
+}
+
+void mlBuildGraph::SetCache(int Index, const QString& Manifest, const QList<mlBuildInput>& Inputs,
+                            const QStringList& Excludes, const QStringList& Outputs)
+{
+	auto& step = mSteps[Index];
+	step.CacheManifest = Manifest;
+	step.CacheInputs = Inputs;
+	step.CacheExcludes = Excludes;
+	step.CacheOutputs = Outputs;
+}
+
+void mlBuildGraph::SetPool(int Index, const QString& Pool)
+{
+	mSteps[Index].Pool = Pool;
+}
+
+void mlBuildGraph::SetPoolLimit(const QString& Pool, int MaxJobs)
+{
+	mPoolLimits[Pool] = MaxJobs;
+}
+
+QList<int> mlBuildGraph::AllSteps() const
+{
+	auto steps = QList<int>{};
+	for (auto stepIdx = 0; stepIdx < mSteps.count(); stepIdx++)
+		steps.append(stepIdx);
+
+	return steps;
+}
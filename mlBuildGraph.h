@@ -0,0 +1,98 @@
+#pragma once
+
+extern const char* gLanguages[12];
+
+// Everything needed to put a build together, filled from the main window or the command line
+struct mlBuildOptions
+{
+	QString GamePath;
+	QString ToolsPath;
+
+	QStringList Maps;
+	QList<QPair<QString, QString>> ModZones; // Mod folder and zone name
+
+	bool Compile;
+	bool CompileEntsOnly;
+	bool Light;
+	int LightQuality; // 0 = Low, 1 = Medium, 2 = High
+	bool Link;
+	QString Language; // A single language or "All"
+	int LinkShards;    // With "All" languages, the number of linker runs the languages are split over, 0 or 1 links them in one run
+	int LinkShardJobs; // Maximum number of link shards run at the same time, 0 only limits them by the build jobs
+
+	bool Run;
+	QStringList RunDvars;
+	QString RunOptions;
+};
+
+struct mlBuildStep
+{
+	QString Name;
+	QString Target; // The map or mod/zone the step builds, empty for steps that aren't specific to one
+	QString Program; // Empty for steps that only merge the results of their dependencies, see AddMergeStep
+	QStringList Arguments;
+	QList<int> Dependencies;
+
+	// Steps in the same pool share the pool's limit on how many of them run at the same time
+	QString Pool;
+
+	// Wait for the dependencies to finish but run even if they failed, used for launching the game with "Ignore Errors"
+	bool RunAfterFailure;
+
+	// Steps with a manifest are skipped when their inputs match the ones recorded after the last successful run
+	// and all of their outputs still exist, see mlBuildCache
+	QString CacheManifest;
+	QList<mlBuildInput> CacheInputs;
+	QStringList CacheExcludes;
+	QStringList CacheOutputs;
+};
+
+// Steps can only depend on steps that were added before them, so the step list is always in a valid execution order
+class mlBuildGraph
+{
+public:
+	// gdtdb is the root of the graph, each map is a compile -> light -> link chain and every zone links independently.
+	// Links of all languages can be split into shards that are merged back into a single link step.
+	static mlBuildGraph Create(const mlBuildOptions& Options);
+
+	int AddUpdateDBStep(const QString& GamePath, const QString& ToolsPath);
+
+	int AddStep(const QString& Target, const QString& Action, const QString& Program, const QStringList& Arguments,
+	            const QList<int>& Dependencies = QList<int>(), bool RunAfterFailure = false);
+
+	// Runs nothing, it finishes as soon as all of its parts did and only succeeds if all of them succeeded
+	int AddMergeStep(const QString& Target, const QString& Action, const QList<int>& Parts);
+
+	int Count() const
+	{
+		return mSteps.count();
+	}
+
+	bool IsEmpty() const
+	{
+		return mSteps.isEmpty();
+	}
+
+	const mlBuildStep& Step(int Index) const
+	{
+		return mSteps[Index];
+	}
+
+	void SetCache(int Index, const QString& Manifest, const QList<mlBuildInput>& Inputs, const QStringList& Excludes,
+	              const QStringList& Outputs);
+
+	void SetPool(int Index, const QString& Pool);
+	void SetPoolLimit(const QString& Pool, int MaxJobs);
+
+	// 0 when the pool is only limited by the build jobs
+	int PoolLimit(const QString& Pool) const
+	{
+		return mPoolLimits.value(Pool, 0);
+	}
+
+	QList<int> AllSteps() const;
+
+protected:
+	QList<mlBuildStep> mSteps;
+	QHash<QString, int> mPoolLimits;
+};
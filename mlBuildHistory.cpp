@@ -0,0 +1,132 @@
+#include "stdafx.h"
+
+#include <algorithm>
+
+static QMutex gBuildHistoryMutex;
+static const qint64 gMaxHistorySize = 8 * 1024 * 1024;
+
+// Calls Line for every line from the last one to the first, until it returns false
+static void ReadLinesBackwards(const QString& FilePath, const std::function<bool(const QByteArray&)>& Line)
+{
+	auto file = QFile{FilePath};
+	if (!file.open(QIODevice::ReadOnly))
+		return;
+
+	const auto blockSize = qint64{64 * 1024};
+	auto position = file.size();
+	auto partialLine = QByteArray{}; // The end of a line whose start is in the block before
+
+	while (position > 0)
+	{
+		const auto readSize = qMin(blockSize, position);
+		position -= readSize;
+
+		if (!file.seek(position))
+			return;
+
+		const auto block = file.read(readSize) + partialLine;
+		auto lineEnd = block.size();
+
+		while (lineEnd > 0)
+		{
+			const auto lineBreak = block.lastIndexOf('\n', lineEnd - 1);
+			if (lineBreak < 0)
+				break;
+
+			const auto line = block.mid(lineBreak + 1, lineEnd - lineBreak - 1);
+			if (!line.isEmpty() && !Line(line))
+				return;
+
+			lineEnd = lineBreak;
+		}
+
+		partialLine = block.left(lineEnd);
+	}
+
+	if (!partialLine.isEmpty())
+		Line(partialLine);
+}
+
+QString mlBuildHistory::FilePath()
+{
+	return QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation) + "/build_history.jsonl";
+}
+
+QString mlBuildHistory::PreviousFilePath()
+{
+	return QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation) + "/build_history.1.jsonl";
+}
+
+void mlBuildHistory::Append(const mlBuildRecord& Record)
+{
+	auto object = QJsonObject{};
+	object["Tool"] = Record.Tool;
+	object["Arguments"] = QJsonArray::fromStringList(Record.Arguments);
+	object["Target"] = Record.Target;
+	object["Start"] = Record.Start.toString(Qt::ISODateWithMs);
+	object["Duration"] = static_cast<double>(Record.Duration);
+	object["ExitCode"] = Record.ExitCode;
+	object["OutputSize"] = static_cast<double>(Record.OutputSize);
+	object["PeakMemory"] = static_cast<double>(Record.PeakMemory);
+	object["CpuTime"] = static_cast<double>(Record.CpuTime);
+
+	const auto line = QJsonDocument(object).toJson(QJsonDocument::Compact) + '\n';
+
+	const QMutexLocker lock(&gBuildHistoryMutex);
+
+	const auto filePath = FilePath();
+	QDir{}.mkpath(QFileInfo(filePath).absolutePath());
+
+	auto file = QFile{filePath};
+	if (!file.open(QIODevice::WriteOnly | QIODevice::Append))
+		return;
+
+	file.write(line);
+
+	// A full file holds far more steps than anyone reads back, it replaces the previous one
+	if (file.size() >= gMaxHistorySize)
+	{
+		file.close();
+		QFile::remove(PreviousFilePath());
+		QFile::rename(filePath, PreviousFilePath());
+	}
+}
+
+QList<mlBuildRecord> mlBuildHistory::Load(int MaxRecords)
+{
+	auto records = QList<mlBuildRecord>{};
+	if (MaxRecords <= 0)
+		return records;
+
+	// Lines cut short by a crash don't parse and are skipped
+	auto readRecord = [&records, MaxRecords](const QByteArray& Line)
+	{
+		const auto object = QJsonDocument::fromJson(Line).object();
+		if (object.isEmpty())
+			return true;
+
+		auto record = mlBuildRecord{};
+		record.Tool = object["Tool"].toString();
+		for (const auto& argument : object["Arguments"].toArray())
+			record.Arguments.append(argument.toString());
+		record.Target = object["Target"].toString();
+		record.Start = QDateTime::fromString(object["Start"].toString(), Qt::ISODateWithMs);
+		record.Duration = static_cast<qint64>(object["Duration"].toDouble());
+		record.ExitCode = object["ExitCode"].toInt();
+		record.OutputSize = static_cast<qint64>(object["OutputSize"].toDouble());
+		record.PeakMemory = static_cast<qint64>(object["PeakMemory"].toDouble(-1));
+		record.CpuTime = static_cast<qint64>(object["CpuTime"].toDouble(-1));
+
+		records.append(record);
+		return records.count() < MaxRecords;
+	};
+
+	const QMutexLocker lock(&gBuildHistoryMutex);
+
+	ReadLinesBackwards(FilePath(), readRecord);
+	if (records.count() < MaxRecords)
+		ReadLinesBackwards(PreviousFilePath(), readRecord);
+
+	std::reverse(records.begin(), records.end());
+	return records;
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+struct mlBuildRecord
+{
+	QString Tool;
+	QStringList Arguments;
+	QString Target;
+	QDateTime Start;
+	qint64 Duration;   // Milliseconds
+	int ExitCode;      // -1 when the tool crashed, was killed or couldn't be started
+	qint64 OutputSize; // Bytes
+	qint64 PeakMemory; // Bytes, -1 when not available
+	qint64 CpuTime;    // Milliseconds of user and kernel time, -1 when not available
+};
+
+// Every executed build step is appended as one JSON object per line, so recording is cheap and a crash loses at most
+// the step that was running. A full file is kept as the previous history and a new one started, so at most two files'
+// worth of steps are kept.
+class mlBuildHistory
+{
+public:
+	static QString FilePath();
+	static QString PreviousFilePath();
+
+	static void Append(const mlBuildRecord& Record);
+
+	// The most recent records, oldest first. The files are read from their end, so this only costs what it returns.
+	static QList<mlBuildRecord> Load(int MaxRecords = 10000);
+};
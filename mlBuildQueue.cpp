@@ -0,0 +1,284 @@
+#include "stdafx.h"
+
+// Everything but the maps and zones, jobs with the same settings can be merged into one
+static bool SameSettings(const mlBuildJob& First, const mlBuildJob& Second)
+{
+	const auto& first = First.Options;
+	const auto& second = Second.Options;
+
+	return First.IgnoreErrors == Second.IgnoreErrors && First.ForceRebuild == Second.ForceRebuild &&
+		first.Compile == second.Compile && first.CompileEntsOnly == second.CompileEntsOnly && first.Light == second.Light &&
+		first.LightQuality == second.LightQuality && first.Link == second.Link && first.Language == second.Language &&
+		first.LinkShards == second.LinkShards && first.LinkShardJobs == second.LinkShardJobs && first.Run == second.Run &&
+		first.RunDvars == second.RunDvars && first.RunOptions == second.RunOptions;
+}
+
+static QStringList ZoneNames(const mlBuildOptions& Options)
+{
+	auto zones = QStringList{};
+	for (const auto& modZone : Options.ModZones)
+		zones.append(modZone.second.isEmpty() ? modZone.first : modZone.first + "/" + modZone.second);
+
+	return zones;
+}
+
+QString mlBuildJob::Description() const
+{
+	if (Type == ML_JOB_UPDATE_DB)
+		return "gdtdb /update";
+
+	auto actions = QStringList{};
+	if (Options.Compile)
+		actions << (Options.CompileEntsOnly ? "compile ents" : "compile");
+	if (Options.Light)
+		actions << QString("light %1").arg(QStringList({"low", "medium", "high"}).value(Options.LightQuality));
+	if (Options.Link)
+		actions << "link";
+	if (Options.Run)
+		actions << "run";
+
+	return QString("%1 (%2)").arg((Options.Maps + ZoneNames(Options)).join(", "), actions.join(", "));
+}
+
+bool mlBuildJob::UpdatesDB() const
+{
+	if (Type == ML_JOB_UPDATE_DB)
+		return true;
+
+	const auto hasTargets = !Options.Maps.isEmpty() || !Options.ModZones.isEmpty();
+	return hasTargets && (Options.Link || (!Options.Maps.isEmpty() && (Options.Compile || Options.Light)));
+}
+
+mlBuildGraph mlBuildJob::CreateGraph() const
+{
+	if (Type == ML_JOB_BUILD)
+		return mlBuildGraph::Create(Options);
+
+	auto graph = mlBuildGraph{};
+	graph.AddUpdateDBStep(Options.GamePath, Options.ToolsPath);
+	return graph;
+}
+
+mlBuildQueue::mlBuildQueue()
+	: mRunning(false)
+{
+}
+
+QString mlBuildQueue::FilePath()
+{
+	return QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation) + "/build_queue.json";
+}
+
+mlEnqueueResult mlBuildQueue::Enqueue(const mlBuildJob& Job)
+{
+	auto result = ML_ENQUEUE_ADDED;
+	auto targetIdx = mJobs.count();
+
+	for (auto jobIdx = mRunning ? 1 : 0; jobIdx < mJobs.count(); jobIdx++)
+	{
+		auto& queued = mJobs[jobIdx];
+
+		// Any queued job that updates the GDT database makes another update redundant
+		if (Job.Type == ML_JOB_UPDATE_DB)
+		{
+			if (queued.UpdatesDB())
+				return ML_ENQUEUE_DUPLICATE;
+
+			continue;
+		}
+
+		if (queued.Type != ML_JOB_BUILD || !SameSettings(queued, Job))
+			continue;
+
+		auto newMaps = QStringList{};
+		for (const auto& mapName : Job.Options.Maps)
+		{
+			if (!queued.Options.Maps.contains(mapName))
+				newMaps.append(mapName);
+		}
+
+		auto newZones = QList<QPair<QString, QString>>{};
+		for (const auto& modZone : Job.Options.ModZones)
+		{
+			if (!queued.Options.ModZones.contains(modZone))
+				newZones.append(modZone);
+		}
+
+		if (newMaps.isEmpty() && newZones.isEmpty())
+			return ML_ENQUEUE_DUPLICATE;
+
+		// Running the game starts the last map or mod of the job, adding targets would change what gets launched
+		if (queued.Options.Run)
+			continue;
+
+		queued.Options.Maps << newMaps;
+		queued.Options.ModZones << newZones;
+		result = ML_ENQUEUE_MERGED;
+		targetIdx = jobIdx;
+		break;
+	}
+
+	if (result == ML_ENQUEUE_ADDED)
+		mJobs.append(Job);
+
+	// A build updates the database itself, standalone updates waiting in front of it are redundant. A standalone update
+	// also counts as updating the database, it must not prune itself.
+	if (Job.Type == ML_JOB_BUILD && Job.UpdatesDB())
+	{
+		for (auto jobIdx = mJobs.count() - 1; jobIdx >= (mRunning ? 1 : 0); jobIdx--)
+		{
+			if (jobIdx != targetIdx && mJobs[jobIdx].Type == ML_JOB_UPDATE_DB)
+				mJobs.removeAt(jobIdx);
+		}
+	}
+
+	Save();
+	return result;
+}
+
+bool mlBuildQueue::Start()
+{
+	if (mRunning || mJobs.isEmpty())
+		return false;
+
+	mRunning = true;
+	return true;
+}
+
+void mlBuildQueue::Finish()
+{
+	if (!mRunning)
+		return;
+
+	mJobs.removeFirst();
+	mRunning = false;
+	Save();
+}
+
+void mlBuildQueue::Resume()
+{
+	const auto pausedJobs = mPausedJobs;
+	mPausedJobs.clear();
+
+	for (const auto& job : pausedJobs)
+		Enqueue(job);
+
+	Save();
+}
+
+void mlBuildQueue::DiscardPaused()
+{
+	mPausedJobs.clear();
+	Save();
+}
+
+bool mlBuildQueue::Remove(int Index)
+{
+	if (Index >= mJobs.count() && Index < mJobs.count() + mPausedJobs.count())
+	{
+		mPausedJobs.removeAt(Index - mJobs.count());
+		Save();
+		return true;
+	}
+
+	if (Index < (mRunning ? 1 : 0) || Index >= mJobs.count())
+		return false;
+
+	mJobs.removeAt(Index);
+	Save();
+	return true;
+}
+
+bool mlBuildQueue::Move(int From, int To)
+{
+	const auto first = mRunning ? 1 : 0;
+	if (From < first || From >= mJobs.count() || To < first || To >= mJobs.count())
+		return false;
+
+	mJobs.move(From, To);
+	Save();
+	return true;
+}
+
+void mlBuildQueue::Load(const QString& GamePath, const QString& ToolsPath)
+{
+	auto file = QFile{FilePath()};
+	if (!file.open(QIODevice::ReadOnly))
+		return;
+
+	for (const auto& value : QJsonDocument::fromJson(file.readAll()).object()["Jobs"].toArray())
+	{
+		const auto object = value.toObject();
+
+		auto job = mlBuildJob{};
+		job.Type = object["Type"].toString() == "UpdateDB" ? ML_JOB_UPDATE_DB : ML_JOB_BUILD;
+		job.IgnoreErrors = object["IgnoreErrors"].toBool();
+		job.ForceRebuild = object["ForceRebuild"].toBool();
+
+		auto& options = job.Options;
+		options.GamePath = GamePath;
+		options.ToolsPath = ToolsPath;
+
+		for (const auto& mapName : object["Maps"].toArray())
+			options.Maps.append(mapName.toString());
+
+		for (const auto& zone : object["ModZones"].toArray())
+			options.ModZones.append(QPair<QString, QString>(zone.toString().section('/', 0, 0), zone.toString().section('/', 1)));
+
+		options.Compile = object["Compile"].toBool();
+		options.CompileEntsOnly = object["CompileEntsOnly"].toBool();
+		options.Light = object["Light"].toBool();
+		options.LightQuality = object["LightQuality"].toInt(1);
+		options.Link = object["Link"].toBool();
+		options.Language = object["Language"].toString("english");
+		options.LinkShards = object["LinkShards"].toInt(1);
+		options.LinkShardJobs = object["LinkShardJobs"].toInt();
+		options.Run = object["Run"].toBool();
+		for (const auto& dvar : object["RunDvars"].toArray())
+			options.RunDvars.append(dvar.toString());
+		options.RunOptions = object["RunOptions"].toString();
+
+		mPausedJobs.append(job);
+	}
+}
+
+void mlBuildQueue::Save() const
+{
+	auto jobs = QJsonArray{};
+	for (const auto& job : mJobs + mPausedJobs)
+	{
+		const auto& options = job.Options;
+
+		auto object = QJsonObject{};
+		object["Type"] = job.Type == ML_JOB_UPDATE_DB ? "UpdateDB" : "Build";
+		object["IgnoreErrors"] = job.IgnoreErrors;
+		object["ForceRebuild"] = job.ForceRebuild;
+		object["Maps"] = QJsonArray::fromStringList(options.Maps);
+		object["ModZones"] = QJsonArray::fromStringList(ZoneNames(options));
+		object["Compile"] = options.Compile;
+		object["CompileEntsOnly"] = options.CompileEntsOnly;
+		object["Light"] = options.Light;
+		object["LightQuality"] = options.LightQuality;
+		object["Link"] = options.Link;
+		object["Language"] = options.Language;
+		object["LinkShards"] = options.LinkShards;
+		object["LinkShardJobs"] = options.LinkShardJobs;
+		object["Run"] = options.Run;
+		object["RunDvars"] = QJsonArray::fromStringList(options.RunDvars);
+		object["RunOptions"] = options.RunOptions;
+		jobs.append(object);
+	}
+
+	auto root = QJsonObject{};
+	root["Jobs"] = jobs;
+
+	const auto filePath = FilePath();
+	QDir{}.mkpath(QFileInfo(filePath).absolutePath());
+
+	auto file = QSaveFile{filePath};
+	if (file.open(QIODevice::WriteOnly))
+	{
+		file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+		file.commit();
+	}
+}
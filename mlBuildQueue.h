@@ -0,0 +1,90 @@
+#pragma once
+
+enum mlBuildJobType
+{
+	ML_JOB_BUILD,
+	ML_JOB_UPDATE_DB
+};
+
+struct mlBuildJob
+{
+	mlBuildJobType Type;
+	mlBuildOptions Options; // Only used by ML_JOB_BUILD
+	bool IgnoreErrors;
+	bool ForceRebuild;
+
+	QString Description() const;
+	bool UpdatesDB() const;
+	mlBuildGraph CreateGraph() const;
+};
+
+enum mlEnqueueResult
+{
+	ML_ENQUEUE_ADDED,
+	ML_ENQUEUE_MERGED,   // The targets were added to a queued job with the same settings
+	ML_ENQUEUE_DUPLICATE // A queued job already does everything the new one would
+};
+
+// Jobs run one after the other, the first one is the running job while a build is in progress. Only jobs that haven't
+// started yet are merged with, moved or removed. The queue is saved after every change so it survives a restart, but
+// the jobs it restores are paused until they're resumed, a job that crashed the launcher shouldn't run again unasked.
+class mlBuildQueue
+{
+public:
+	mlBuildQueue();
+
+	static QString FilePath();
+
+	mlEnqueueResult Enqueue(const mlBuildJob& Job);
+
+	// Marks the first job as running, returns false if there is nothing to start
+	bool Start();
+	void Finish();
+
+	bool IsRunning() const
+	{
+		return mRunning;
+	}
+
+	int Count() const
+	{
+		return mJobs.count();
+	}
+
+	bool IsEmpty() const
+	{
+		return mJobs.isEmpty();
+	}
+
+	const mlBuildJob& Job(int Index) const
+	{
+		return mJobs[Index];
+	}
+
+	// Paused jobs come after the queued ones, they aren't merged with and don't run until Resume() queues them
+	int PausedCount() const
+	{
+		return mPausedJobs.count();
+	}
+
+	const mlBuildJob& PausedJob(int Index) const
+	{
+		return mPausedJobs[Index];
+	}
+
+	void Resume();
+	void DiscardPaused();
+
+	// Indices past Count() remove paused jobs
+	bool Remove(int Index);
+	bool Move(int From, int To);
+
+	// Paths aren't saved, the jobs are always built in the current game folder. The loaded jobs are paused.
+	void Load(const QString& GamePath, const QString& ToolsPath);
+	void Save() const;
+
+protected:
+	QList<mlBuildJob> mJobs;
+	QList<mlBuildJob> mPausedJobs;
+	bool mRunning;
+};
@@ -0,0 +1,1104 @@
+#include "stdafx.h"
+#include "mlMainWindow.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <iterator>
+
+#ifdef Q_OS_WIN
+#include <Psapi.h>
+#include <fcntl.h>
+#include <io.h>
+#else
+#include <csignal>
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+enum mlExitCode
+{
+	ML_EXIT_SUCCESS = 0,
+	ML_EXIT_BUILD_FAILED = 1,
+	ML_EXIT_USAGE = 2
+};
+
+// Ctrl+C cancels the build the same way the Cancel button does, so the tools started by the build are killed too
+static std::atomic<mlBuildThread*> gCommandLineBuild{nullptr};
+
+#ifdef Q_OS_WIN
+static BOOL WINAPI ConsoleCtrlHandler(DWORD CtrlType)
+{
+	auto* buildThread = gCommandLineBuild.load();
+	if ((CtrlType != CTRL_C_EVENT && CtrlType != CTRL_BREAK_EVENT) || buildThread == nullptr)
+		return FALSE;
+
+	buildThread->Cancel();
+	return TRUE;
+}
+#else
+// Only async-signal-safe calls are allowed in the handler, it wakes up a socket notifier on the main thread instead
+static int gCancelPipe[2] = {-1, -1};
+
+static void CancelSignalHandler(int)
+{
+	const char wake = 1;
+	const auto result = write(gCancelPipe[1], &wake, 1);
+	Q_UNUSED(result);
+}
+#endif
+
+// Runs the graph to completion on a worker thread, the calling thread handles the output and cancelling meanwhile
+static bool RunBuild(const mlBuildGraph& Graph, int Jobs, bool IgnoreErrors, bool ForceRebuild)
+{
+	mlBuildThread buildThread(Graph, Jobs, mlResourceLimits::FromSettings(), IgnoreErrors, ForceRebuild);
+
+	// Same as the output pane, every chunk starts on a new line
+	QObject::connect(&buildThread, &mlBuildThread::OutputReady, [](const QString& Output)
+	{
+		const auto output = Output.toLocal8Bit();
+		fwrite(output.constData(), 1, output.size(), stdout);
+		if (!output.endsWith('\n'))
+			fputc('\n', stdout);
+		fflush(stdout);
+	});
+
+	QEventLoop eventLoop;
+	QObject::connect(&buildThread, &QThread::finished, &eventLoop, &QEventLoop::quit);
+
+	gCommandLineBuild = &buildThread;
+
+#ifdef Q_OS_WIN
+	SetConsoleCtrlHandler(ConsoleCtrlHandler, TRUE);
+#else
+	QScopedPointer<QSocketNotifier> cancelNotifier;
+	if (pipe(gCancelPipe) == 0)
+	{
+		cancelNotifier.reset(new QSocketNotifier(gCancelPipe[0], QSocketNotifier::Read));
+		QObject::connect(cancelNotifier.data(), &QSocketNotifier::activated, [&buildThread]()
+		{
+			buildThread.Cancel();
+		});
+
+		signal(SIGINT, CancelSignalHandler);
+		signal(SIGTERM, CancelSignalHandler);
+	}
+#endif
+
+	buildThread.start();
+	eventLoop.exec();
+	buildThread.wait();
+
+#ifdef Q_OS_WIN
+	SetConsoleCtrlHandler(ConsoleCtrlHandler, FALSE);
+#else
+	signal(SIGINT, SIG_DFL);
+	signal(SIGTERM, SIG_DFL);
+
+	if (cancelNotifier)
+	{
+		cancelNotifier.reset();
+		close(gCancelPipe[0]);
+		close(gCancelPipe[1]);
+		gCancelPipe[0] = gCancelPipe[1] = -1;
+	}
+#endif
+
+	gCommandLineBuild = nullptr;
+
+	return buildThread.Succeeded();
+}
+
+// Well formed exports of about the given size for the benchmarks, so they don't need a game install
+static QByteArray SyntheticModelExport(qint64 Size)
+{
+	const auto vertCount = qMax(Size / 400, qint64{1});
+
+	auto data = QByteArray{};
+	data.reserve(Size + 4096);
+	data += "// Export filename: synthetic.xmodel_export\nMODEL\nVERSION 6\n\nNUMBONES 1\nBONE 0 -1 \"tag_origin\"\n\n"
+		"BONE 0\nOFFSET 0.000000, 0.000000, 0.000000\nSCALE 1.000000, 1.000000, 1.000000\n"
+		"X 1.000000, 0.000000, 0.000000\nY 0.000000, 1.000000, 0.000000\nZ 0.000000, 0.000000, 1.000000\n\n";
+
+	data += "NUMVERTS " + QByteArray::number(vertCount) + '\n';
+	for (auto vertIdx = qint64{0}; vertIdx < vertCount; vertIdx++)
+		data += "VERT " + QByteArray::number(vertIdx) + "\nOFFSET 1.250000, -3.500000, 12.750000\nBONES 1\nBONE 0 1.000000\n";
+
+	data += "\nNUMFACES " + QByteArray::number(vertCount) + '\n';
+	for (auto faceIdx = qint64{0}; faceIdx < vertCount; faceIdx++)
+	{
+		data += "TRI 0 0 0 0\n";
+		for (auto corner = 0; corner < 3; corner++)
+			data += "VERT " + QByteArray::number((faceIdx + corner) % vertCount) + "\nNORMAL 0.000000 0.000000 1.000000\n"
+				"COLOR 1.000000 1.000000 1.000000 1.000000\nUV 1 0.500000 0.500000\n";
+	}
+
+	data += "\nNUMOBJECTS 1\nOBJECT 0 \"synthetic\"\n\nNUMMATERIALS 1\nMATERIAL 0 \"synthetic\" \"Lambert\" \"\"\n";
+	return data;
+}
+
+static QByteArray SyntheticAnimExport(qint64 Size)
+{
+	const auto partCount = 4;
+	const auto frameCount = qMax(Size / (partCount * 160), qint64{1});
+
+	auto data = QByteArray{};
+	data.reserve(Size + 4096);
+	data += "// Export filename: synthetic.xanim_export\nANIMATION\nVERSION 3\n\nNUMPARTS " + QByteArray::number(partCount) + '\n';
+	for (auto partIdx = 0; partIdx < partCount; partIdx++)
+		data += "PART " + QByteArray::number(partIdx) + " \"j_bone_" + QByteArray::number(partIdx) + "\"\n";
+
+	data += "\nFRAMERATE 30\nNUMFRAMES " + QByteArray::number(frameCount) + '\n';
+	for (auto frameIdx = qint64{0}; frameIdx < frameCount; frameIdx++)
+	{
+		data += "FRAME " + QByteArray::number(frameIdx) + '\n';
+		for (auto partIdx = 0; partIdx < partCount; partIdx++)
+			data += "PART " + QByteArray::number(partIdx) + "\nOFFSET 0.000000, 2.500000, -1.250000\n"
+				"X 1.000000, 0.000000, 0.000000\nY 0.000000, 1.000000, 0.000000\nZ 0.000000, 0.000000, 1.000000\n";
+	}
+
+	data += "\nNOTETRACKS\n\nPART 0\nNUMTRACKS 0\n";
+	return data;
+}
+
+// Writes Count exports to the folder, alternating between models and animations
+static QStringList WriteSyntheticExports(const QString& Folder, int Count, qint64 Size)
+{
+	const auto model = SyntheticModelExport(Size);
+	const auto anim = SyntheticAnimExport(Size);
+
+	auto files = QStringList{};
+	for (auto fileIdx = 0; fileIdx < Count; fileIdx++)
+	{
+		const auto isAnim = fileIdx % 2 == 1;
+		const auto filePath = QString("%1/synthetic_%2.%3").arg(Folder).arg(fileIdx, 5, 10, QChar('0')).arg(isAnim ? "XANIM_EXPORT" : "XMODEL_EXPORT");
+
+		auto file = QFile{filePath};
+		if (!file.open(QIODevice::WriteOnly) || file.write(isAnim ? anim : model) != (isAnim ? anim : model).size())
+			return QStringList();
+
+		files.append(filePath);
+	}
+
+	return files;
+}
+
+// Peak memory the launcher itself used so far in bytes, the converters are separate processes and don't count
+static qint64 PeakResidentSize()
+{
+#ifdef Q_OS_WIN
+	auto counters = PROCESS_MEMORY_COUNTERS{};
+	if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+		return static_cast<qint64>(counters.PeakWorkingSetSize);
+	return -1;
+#else
+	auto usage = rusage{};
+	if (getrusage(RUSAGE_SELF, &usage) == 0)
+		return static_cast<qint64>(usage.ru_maxrss) * 1024;
+	return -1;
+#endif
+}
+
+// Stand-in for export2bin with --stub: copies stdin to stdout and takes LatencyMs longer than that to do it
+static int StubExport2Bin(int LatencyMs)
+{
+#ifdef Q_OS_WIN
+	_setmode(_fileno(stdin), _O_BINARY);
+	_setmode(_fileno(stdout), _O_BINARY);
+#endif
+
+	auto data = QByteArray{};
+	char buffer[64 * 1024];
+	for (auto size = fread(buffer, 1, sizeof(buffer), stdin); size > 0; size = fread(buffer, 1, sizeof(buffer), stdin))
+		data.append(buffer, static_cast<int>(size));
+
+	if (LatencyMs > 0)
+		QThread::msleep(LatencyMs);
+
+	fwrite(data.constData(), 1, data.size(), stdout);
+	fflush(stdout);
+	return ML_EXIT_SUCCESS;
+}
+
+// Stand-in for a tool that starts tools of its own with --benchmark-cancel: records its pid in the folder, starts two
+// copies of itself one level further down and waits to be killed
+static int StubProcessTree(int Depth, const QString& PidFolder)
+{
+	auto pidFile = QFile{QString("%1/%2.pid").arg(PidFolder).arg(QCoreApplication::applicationPid())};
+	pidFile.open(QIODevice::WriteOnly);
+	pidFile.close();
+
+	for (auto childIdx = 0; Depth > 0 && childIdx < 2; childIdx++)
+	{
+		auto* child = new QProcess;
+		child->start(QCoreApplication::applicationFilePath(), QStringList{"--stub-process-tree", QString::number(Depth - 1), PidFolder});
+	}
+
+	for (;;)
+		QThread::sleep(1);
+}
+
+// Runs the converter on every file one after the other without the launcher in between, the difference to a single
+// worker conversion is what the launcher adds per file
+static qint64 ConvertDirectly(const QStringList& Files, const QString& Program, const QStringList& Arguments)
+{
+	auto timer = QElapsedTimer{};
+	timer.start();
+
+	for (const auto& filePath : Files)
+	{
+		auto file = QFile{filePath};
+		if (!file.open(QIODevice::ReadOnly))
+			return -1;
+
+		auto process = QProcess{};
+		process.start(Program, Arguments);
+		if (!process.waitForStarted())
+			return -1;
+
+		process.write(file.readAll());
+		process.closeWriteChannel();
+		process.waitForFinished(-1);
+		process.readAllStandardOutput();
+
+		if (process.exitStatus() != QProcess::NormalExit || process.exitCode() != 0)
+			return -1;
+	}
+
+	return timer.elapsed();
+}
+
+// Converts the files once directly, once with a single worker and once with the given number of workers into scratch
+// folders. The cache is left out so every run converts every file.
+static int BenchmarkExport2Bin(const QStringList& Inputs, int Workers, bool Stub, int StubLatency)
+{
+	auto files = QStringList{};
+	auto totalSize = qint64{0};
+
+	for (const auto& input : Inputs)
+	{
+		const auto fileInfo = QFileInfo{input};
+		if (fileInfo.isDir())
+		{
+			QDirIterator it(input, QStringList() << "*.XANIM_EXPORT" << "*.XMODEL_EXPORT", QDir::Files, QDirIterator::Subdirectories);
+			while (it.hasNext())
+			{
+				files.append(it.next());
+				totalSize += it.fileInfo().size();
+			}
+		}
+		else if (fileInfo.isFile())
+		{
+			files.append(fileInfo.absoluteFilePath());
+			totalSize += fileInfo.size();
+		}
+	}
+
+	if (files.isEmpty())
+	{
+		fprintf(stderr, "No *_EXPORT files to convert\n");
+		return ML_EXIT_USAGE;
+	}
+
+	const auto program = Stub ? QCoreApplication::applicationFilePath() : mlConvertThread::DefaultConverterPath();
+	const auto programArguments = Stub ? QStringList{"--stub-export2bin", QString::number(StubLatency)} : QStringList();
+
+	fprintf(stdout, "Export2Bin benchmark: %d files, %.1f MB, %s\n", files.count(), totalSize / (1024.0 * 1024.0),
+	        Stub ? qPrintable(QString("stub converter with %1 ms latency").arg(StubLatency)) : "export2bin");
+
+	const auto directTime = ConvertDirectly(files, program, programArguments + QStringList{"/piped"});
+	if (directTime < 0)
+	{
+		fprintf(stderr, "Could not run '%s' on the files\n", qPrintable(program));
+		return ML_EXIT_BUILD_FAILED;
+	}
+
+	fprintf(stdout, "  direct:     %6lld ms, %7.1f files/s, %7.1f MB/s\n", static_cast<long long>(directTime),
+	        files.count() * 1000.0 / qMax(directTime, qint64{1}), totalSize / (1024.0 * 1024.0) * 1000.0 / qMax(directTime, qint64{1}));
+
+	auto workerCounts = QList<int>() << 1;
+	if (Workers > 1)
+		workerCounts << Workers;
+
+	auto singleTime = qint64{0};
+	for (auto workerCount : workerCounts)
+	{
+		QTemporaryDir outputDir;
+		auto outputPath = outputDir.path();
+
+		mlConvertThread convertThread(files, outputPath, true, true, workerCount);
+		convertThread.SetConverter(program, programArguments);
+		convertThread.SetUseCache(false);
+
+		// Only the summary is interesting, the per-file logs would mostly measure the console
+		auto summary = QString{};
+		QObject::connect(&convertThread, &mlConvertThread::OutputReady, [&summary](const QString& Output)
+		{
+			if (Output.startsWith("Export2Bin: Finished!") || Output.startsWith("ERROR"))
+				summary = Output;
+		});
+
+		auto timer = QElapsedTimer{};
+		timer.start();
+		convertThread.start();
+		convertThread.wait();
+
+		const auto elapsed = qMax(timer.elapsed(), qint64{1});
+		if (workerCount == 1)
+			singleTime = elapsed;
+
+		// Time the launcher spent on each file on top of the converter, only meaningful without parallelism
+		const auto overhead = workerCount == 1
+			? QString(", %1 ms overhead per file").arg(static_cast<double>(elapsed - directTime) / files.count(), 0, 'f', 2)
+			: QString(", %1x").arg(static_cast<double>(singleTime) / elapsed, 0, 'f', 2);
+
+		fprintf(stdout, "  %2d worker%s %6lld ms, %7.1f files/s, %7.1f MB/s, %.1f MB peak RSS%s\n", workerCount, workerCount == 1 ? ": " : "s:",
+		        static_cast<long long>(elapsed), files.count() * 1000.0 / elapsed, totalSize / (1024.0 * 1024.0) * 1000.0 / elapsed,
+		        PeakResidentSize() / (1024.0 * 1024.0), qPrintable(overhead));
+
+		if (!convertThread.Succeeded())
+		{
+			fprintf(stderr, "%s\n", qPrintable(summary.isEmpty() ? QString("Export2Bin failed") : summary));
+			return ML_EXIT_BUILD_FAILED;
+		}
+	}
+
+	fflush(stdout);
+	return ML_EXIT_SUCCESS;
+}
+
+// Validates the files over and over for at least a second and reports how fast the validator reads them
+static int BenchmarkValidator(const QStringList& Inputs)
+{
+	auto files = QStringList{};
+	for (const auto& input : Inputs)
+	{
+		if (QFileInfo(input).isDir())
+		{
+			QDirIterator it(input, QStringList() << "*.XANIM_EXPORT" << "*.XMODEL_EXPORT", QDir::Files, QDirIterator::Subdirectories);
+			while (it.hasNext())
+				files.append(it.next());
+		}
+		else
+			files.append(input);
+	}
+
+	const auto synthetic = files.isEmpty() ? SyntheticModelExport(qint64{256} * 1024 * 1024) : QByteArray();
+	if (files.isEmpty())
+		fprintf(stdout, "Validator benchmark: synthetic model export, %.1f MB\n", synthetic.size() / (1024.0 * 1024.0));
+	else
+		fprintf(stdout, "Validator benchmark: %d files\n", files.count());
+
+	auto totalSize = qint64{0};
+	auto passes = 0;
+	auto rejected = 0;
+
+	auto timer = QElapsedTimer{};
+	timer.start();
+
+	while (passes < 3 || timer.elapsed() < 1000)
+	{
+		rejected = 0;
+
+		if (files.isEmpty())
+		{
+			const auto info = mlExportValidator::Validate(synthetic.constData(), synthetic.size(), false);
+			totalSize += info.Size;
+			if (!info.IsValid())
+			{
+				fprintf(stderr, "The synthetic export was rejected: %s\n", qPrintable(info.Error));
+				return ML_EXIT_BUILD_FAILED;
+			}
+		}
+
+		for (const auto& file : files)
+		{
+			const auto info = mlExportValidator::Validate(file);
+			totalSize += info.Size;
+			if (!info.IsValid())
+			{
+				if (passes == 0)
+					fprintf(stdout, "  Rejected '%s' (%s)\n", qPrintable(file), qPrintable(info.Error));
+				rejected++;
+			}
+		}
+
+		passes++;
+	}
+
+	const auto elapsed = qMax(timer.elapsed(), qint64{1});
+	fprintf(stdout, "  %d passes, %lld ms, %.2f GB/s%s\n", passes, static_cast<long long>(elapsed),
+	        totalSize / (1024.0 * 1024.0 * 1024.0) * 1000.0 / elapsed, rejected > 0 ? qPrintable(QString(", %1 rejected").arg(rejected)) : "");
+
+	fflush(stdout);
+	return ML_EXIT_SUCCESS;
+}
+
+// Floods an output sink from a few threads the way a verbose build does and reports what reaches the GUI side
+static int BenchmarkOutput(int LinesPerMinute, int Seconds, int Producers)
+{
+	QTemporaryDir spillDir;
+	mlOutputSink sink;
+	sink.SetSpillFile(spillDir.filePath("output.txt"));
+
+	if (LinesPerMinute > 0)
+		fprintf(stdout, "Output benchmark: %d lines/minute from %d threads for %d s\n", LinesPerMinute, Producers, Seconds);
+	else
+		fprintf(stdout, "Output benchmark: as many lines as possible from %d threads for %d s\n", Producers, Seconds);
+
+	// Tools write a few lines at a time, each read of their pipe becomes one append
+	const auto chunkLines = 8;
+	std::atomic<qint64> appendCount{0};
+
+	auto flushCount = 0;
+	auto maxFlushLines = 0;
+	auto maxFlushGap = qint64{0};
+	auto flushTimer = QElapsedTimer{};
+	flushTimer.start();
+
+	QObject::connect(&sink, &mlOutputSink::TextReady, [&](const QString& Text)
+	{
+		const auto lineCount = Text.count('\n') + 1;
+		flushCount++;
+		maxFlushLines = qMax(maxFlushLines, lineCount);
+		maxFlushGap = qMax(maxFlushGap, flushTimer.restart());
+	});
+
+	auto threads = QList<mlWorkThread*>{};
+	for (auto producerIdx = 0; producerIdx < Producers; producerIdx++)
+	{
+		auto* thread = new mlWorkThread([=, &appendCount](mlWorkThread& Thread)
+		{
+			const auto linesPerMs = LinesPerMinute / 60000.0 / Producers;
+			auto timer = QElapsedTimer{};
+			timer.start();
+
+			auto lineCount = qint64{0};
+			while (timer.elapsed() < Seconds * 1000)
+			{
+				if (LinesPerMinute > 0 && lineCount >= timer.elapsed() * linesPerMs)
+				{
+					QThread::msleep(1);
+					continue;
+				}
+
+				auto chunk = QStringList{};
+				for (auto lineIdx = 0; lineIdx < chunkLines; lineIdx++, lineCount++)
+					chunk.append(QString("linker %1: processing asset %2 of zone ui_mp_common").arg(producerIdx).arg(lineCount));
+
+				emit Thread.OutputReady(chunk.join('\n'));
+				appendCount++;
+			}
+
+			return true;
+		});
+
+		QObject::connect(thread, SIGNAL(OutputReady(QString)), &sink, SLOT(Append(QString)), Qt::DirectConnection);
+		threads.append(thread);
+	}
+
+	QEventLoop eventLoop;
+	auto runningCount = Producers;
+	for (auto* thread : threads)
+	{
+		QObject::connect(thread, &QThread::finished, &eventLoop, [&]()
+		{
+			if (--runningCount == 0)
+				eventLoop.quit();
+		});
+		thread->start();
+	}
+
+	eventLoop.exec();
+	sink.Flush();
+
+	for (auto* thread : threads)
+	{
+		thread->wait();
+		delete thread;
+	}
+
+	const auto totalLines = sink.LineCount();
+	const auto spillPath = sink.SpillFile();
+	sink.SetSpillFile(QString());
+
+	auto spilledLines = qint64{0};
+	auto spill = QFile{spillPath};
+	if (spill.open(QIODevice::ReadOnly))
+	{
+		while (!spill.atEnd())
+		{
+			const auto block = spill.read(1024 * 1024);
+			spilledLines += block.count('\n');
+		}
+	}
+
+	fprintf(stdout, "  %lld lines, %.0f lines/minute, %lld appends\n", static_cast<long long>(totalLines), totalLines * 60.0 / Seconds,
+	        static_cast<long long>(appendCount.load()));
+	fprintf(stdout, "  %d flushes (%.1f/s), at most %d lines and %lld ms apart\n", flushCount, flushCount / static_cast<double>(Seconds), maxFlushLines,
+	        static_cast<long long>(maxFlushGap));
+	fprintf(stdout, "  %lld lines dropped before reaching the GUI, %lld of %lld lines in the spill file (%.1f MB)\n",
+	        static_cast<long long>(sink.DroppedLineCount()), static_cast<long long>(spilledLines), static_cast<long long>(totalLines), spill.size() / (1024.0 * 1024.0));
+
+	const auto peakSize = PeakResidentSize();
+	if (peakSize >= 0)
+		fprintf(stdout, "  Peak memory %.1f MB\n", peakSize / (1024.0 * 1024.0));
+
+	fflush(stdout);
+	return spilledLines == totalLines ? ML_EXIT_SUCCESS : ML_EXIT_BUILD_FAILED;
+}
+
+// Parses the logs given, the ones in the launcher's logs folder without any, or a generated linker log if there are none of those either, and
+// reports how fast the parser classifies them
+static int BenchmarkLogParser(const QStringList& Inputs)
+{
+	auto files = QStringList{};
+	for (const auto& input : Inputs.isEmpty() ? QStringList{mlMainWindow::LogsPath()} : Inputs)
+	{
+		if (QFileInfo(input).isDir())
+		{
+			QDirIterator it(input, QStringList() << "*.txt" << "*.log", QDir::Files, QDirIterator::Subdirectories);
+			while (it.hasNext())
+				files.append(it.next());
+		}
+		else
+			files.append(input);
+	}
+
+	auto synthetic = QByteArray{};
+	if (files.isEmpty())
+	{
+		// Mostly progress lines, with a few of every kind the parser looks for in between
+		const auto lines = QList<QByteArray>{"Linking zone ui_mp_common: loading image 'i_mtl_p7_wall_brick_c'\n",
+		                                     "Processing xmodel 'p7_foliage_tree_pine' (4 lods, 12 materials)\n",
+		                                     "Processed 1864 of 2437 assets\n",
+		                                     "WARNING: Image 'i_mtl_p7_decal_grime' is larger than 2048x2048\n",
+		                                     "^1ERROR: Could not find xmodel 'p7_zm_der_box_01'\n",
+		                                     "^1ERROR: scripts/zm/zm_mod.gsc(142): syntax error, unexpected TOKEN_RIGHT_PAREN\n"};
+
+		while (synthetic.size() < 256 * 1024 * 1024)
+		{
+			for (auto lineIdx = 0; lineIdx < 200; lineIdx++)
+				synthetic += lines[lineIdx % 3];
+			for (const auto& line : lines.mid(3))
+				synthetic += line;
+		}
+
+		fprintf(stdout, "Log parser benchmark: generated linker log, %.1f MB\n", synthetic.size() / (1024.0 * 1024.0));
+	}
+	else
+		fprintf(stdout, "Log parser benchmark: %d logs\n", files.count());
+
+	auto totalSize = qint64{0};
+	auto totalLines = qint64{0};
+	int counts[ML_LOG_KIND_COUNT] = {};
+
+	auto timer = QElapsedTimer{};
+	timer.start();
+
+	// The output sink hands the parser a line or a few at a time, bigger pieces only make it faster
+	const auto pieceSize = qint64{64 * 1024};
+	auto parse = [&](const char* Data, qint64 Size)
+	{
+		mlLogParser parser;
+		for (auto offset = qint64{0}; offset < Size; offset += pieceSize)
+			parser.Parse(Data + offset, qMin(pieceSize, Size - offset));
+		parser.Parse("\n", 1);
+
+		totalSize += Size;
+		totalLines += parser.LineCount();
+		for (auto kind = 0; kind < ML_LOG_KIND_COUNT; kind++)
+			counts[kind] += parser.Count(static_cast<mlLogLineKind>(kind));
+	};
+
+	if (files.isEmpty())
+		parse(synthetic.constData(), synthetic.size());
+
+	for (const auto& filePath : files)
+	{
+		auto file = QFile{filePath};
+		if (!file.open(QIODevice::ReadOnly) || file.size() == 0)
+			continue;
+
+		const auto* data = file.map(0, file.size());
+		if (data != nullptr)
+			parse(reinterpret_cast<const char*>(data), file.size());
+		else
+		{
+			const auto contents = file.readAll();
+			parse(contents.constData(), contents.size());
+		}
+	}
+
+	const auto elapsed = qMax(timer.elapsed(), qint64{1});
+	fprintf(stdout, "  %.1f MB, %lld lines in %lld ms, %.0f MB/s, %.0f lines/s\n", totalSize / (1024.0 * 1024.0), static_cast<long long>(totalLines),
+	        static_cast<long long>(elapsed), totalSize / (1024.0 * 1024.0) * 1000.0 / elapsed, totalLines * 1000.0 / elapsed);
+
+	for (auto kind = 0; kind < ML_LOG_KIND_COUNT; kind++)
+		fprintf(stdout, "  %s: %d\n", qPrintable(mlLogParser::KindName(static_cast<mlLogLineKind>(kind))), counts[kind]);
+
+	fflush(stdout);
+	return ML_EXIT_SUCCESS;
+}
+
+static bool IsProcessRunning(qint64 Pid)
+{
+#ifdef Q_OS_WIN
+	auto* process = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, static_cast<DWORD>(Pid));
+	if (process == nullptr)
+		return false;
+
+	auto exitCode = DWORD{0};
+	const auto running = GetExitCodeProcess(process, &exitCode) && exitCode == STILL_ACTIVE;
+	CloseHandle(process);
+	return running;
+#else
+	if (::kill(static_cast<pid_t>(Pid), 0) != 0)
+		return false;
+
+	// A killed process whose parent is gone stays a zombie until it's reaped, it doesn't run anymore either
+	auto stat = QFile{QString("/proc/%1/stat").arg(Pid)};
+	if (!stat.open(QIODevice::ReadOnly))
+		return true;
+
+	const auto line = stat.readAll();
+	const auto stateIdx = line.lastIndexOf(')') + 2;
+	return stateIdx <= 1 || stateIdx >= line.size() || line[stateIdx] != 'Z';
+#endif
+}
+
+static void KillProcess(qint64 Pid)
+{
+#ifdef Q_OS_WIN
+	auto* process = OpenProcess(PROCESS_TERMINATE, FALSE, static_cast<DWORD>(Pid));
+	if (process != nullptr)
+	{
+		TerminateProcess(process, 1);
+		CloseHandle(process);
+	}
+#else
+	::kill(static_cast<pid_t>(Pid), SIGKILL);
+#endif
+}
+
+// Builds a single step that starts a tree of stub tools, cancels it once the whole tree is up and checks that the build
+// is idle within BoundMs and that no process of the tree is left running
+static int BenchmarkCancel(int BoundMs)
+{
+	const auto depth = 2;
+	const auto processCount = (1 << (depth + 1)) - 1;
+	const auto startTimeout = 10000;
+
+	QTemporaryDir pidDir;
+	auto graph = mlBuildGraph{};
+	graph.AddStep("stub", "Process Tree", QCoreApplication::applicationFilePath(),
+	              QStringList{"--stub-process-tree", QString::number(depth), pidDir.path()});
+
+	fprintf(stdout, "Cancel benchmark: stub tool with %d processes, at most %d ms from cancelling to idle\n", processCount, BoundMs);
+	fflush(stdout);
+
+	auto pids = [&pidDir]()
+	{
+		auto result = QList<qint64>{};
+		for (const auto& fileName : QDir(pidDir.path()).entryList(QStringList{"*.pid"}, QDir::Files))
+			result.append(QFileInfo(fileName).completeBaseName().toLongLong());
+		return result;
+	};
+
+	mlBuildThread buildThread(graph, 1, mlResourceLimits::FromSettings(), false, false);
+
+	// Only problems are interesting, the rest is the command line of the stub
+	QObject::connect(&buildThread, &mlBuildThread::OutputReady, [](const QString& Output)
+	{
+		if (Output.startsWith("ERROR") || Output.startsWith("WARNING"))
+		{
+			fprintf(stdout, "  %s", qPrintable(Output));
+			fflush(stdout);
+		}
+	});
+
+	QEventLoop eventLoop;
+	QObject::connect(&buildThread, &QThread::finished, &eventLoop, &QEventLoop::quit);
+
+	auto timer = QElapsedTimer{};
+	auto cancelTime = qint64{-1};
+	auto startFailed = false;
+
+	QTimer pollTimer;
+	pollTimer.setInterval(10);
+	QObject::connect(&pollTimer, &QTimer::timeout, [&]()
+	{
+		if (pids().count() < processCount && timer.elapsed() < startTimeout)
+			return;
+
+		startFailed = pids().count() < processCount;
+		pollTimer.stop();
+		cancelTime = timer.elapsed();
+		buildThread.Cancel();
+	});
+
+	timer.start();
+	buildThread.start();
+	pollTimer.start();
+	eventLoop.exec();
+	buildThread.wait();
+
+	const auto idleTime = cancelTime >= 0 ? timer.elapsed() - cancelTime : qint64{-1};
+
+	// Processes that were killed can take a moment to disappear, they get what's left of the bound
+	auto survivors = pids();
+	auto dropStopped = [&survivors]()
+	{
+		survivors.erase(std::remove_if(survivors.begin(), survivors.end(), [](qint64 Pid) { return !IsProcessRunning(Pid); }), survivors.end());
+	};
+
+	dropStopped();
+	while (!survivors.isEmpty() && cancelTime >= 0 && timer.elapsed() - cancelTime < BoundMs)
+	{
+		QThread::msleep(10);
+		dropStopped();
+	}
+
+	for (auto pid : survivors)
+		KillProcess(pid);
+
+	if (cancelTime < 0)
+	{
+		fprintf(stderr, "The stub tool exited before it could be cancelled\n");
+		return ML_EXIT_BUILD_FAILED;
+	}
+
+	if (startFailed)
+	{
+		fprintf(stderr, "Only %d of %d stub processes started within %d ms\n", pids().count(), processCount, startTimeout);
+		return ML_EXIT_BUILD_FAILED;
+	}
+
+	fprintf(stdout, "  idle %lld ms after cancelling, %d of %d processes left running\n", static_cast<long long>(idleTime),
+	        survivors.count(), processCount);
+	fflush(stdout);
+
+	if (idleTime > BoundMs || !survivors.isEmpty())
+	{
+		fprintf(stderr, "Cancelling took longer than %d ms or left processes behind\n", BoundMs);
+		return ML_EXIT_BUILD_FAILED;
+	}
+
+	return ML_EXIT_SUCCESS;
+}
+
+bool mlCommandLine::IsHeadless(int argc, char* argv[])
+{
+	for (auto argIdx = 1; argIdx < argc; argIdx++)
+	{
+		if (qstrcmp(argv[argIdx], "--build") == 0 || qstrcmp(argv[argIdx], "--benchmark-export2bin") == 0 ||
+		    qstrcmp(argv[argIdx], "--benchmark-validator") == 0 || qstrcmp(argv[argIdx], "--benchmark-output") == 0 ||
+		    qstrcmp(argv[argIdx], "--benchmark-log-parser") == 0 || qstrcmp(argv[argIdx], "--benchmark-cancel") == 0 ||
+		    qstrcmp(argv[argIdx], "--stub-export2bin") == 0 || qstrcmp(argv[argIdx], "--stub-process-tree") == 0)
+			return true;
+	}
+
+	return false;
+}
+
+int mlCommandLine::Exec(const QStringList& Arguments)
+{
+	// The stub's stdout is the pipe to the launcher that started it, it must not be swapped for the console below
+	const auto stubIdx = Arguments.indexOf("--stub-export2bin");
+	if (stubIdx >= 0)
+		return StubExport2Bin(Arguments.value(stubIdx + 1).toInt());
+
+	const auto stubTreeIdx = Arguments.indexOf("--stub-process-tree");
+	if (stubTreeIdx >= 0)
+		return StubProcessTree(Arguments.value(stubTreeIdx + 1).toInt(), Arguments.value(stubTreeIdx + 2));
+
+#ifdef Q_OS_WIN
+	// The launcher is a GUI application, borrow the console of whoever started us so the output shows up there
+	if (AttachConsole(ATTACH_PARENT_PROCESS))
+	{
+		freopen("CONOUT$", "w", stdout);
+		freopen("CONOUT$", "w", stderr);
+	}
+#endif
+
+	const auto settings = QSettings{};
+
+	QCommandLineParser parser;
+	parser.setApplicationDescription("Black Ops III Mod Tools Launcher");
+	parser.addHelpOption();
+	parser.addOptions({
+		{"build", "Build the given maps and mods without showing the launcher."},
+		{"map", "Map in usermaps to build, can be given more than once.", "name"},
+		{"all-maps", "Build every map in usermaps."},
+		{"mod", "Mod to build, either a mod folder (all of its zones) or <mod>/<zone>, can be given more than once.", "mod"},
+		{"compile", "Compile the maps, either 'ents' or 'full'.", "mode"},
+		{"light", "Light the maps, either 'low', 'medium' or 'high'.", "quality"},
+		{"link", "Link the maps and mods."},
+		{"lang", "Language to link, either a single language or 'all'.", "language", settings.value("BuildLanguage", "english").toString()},
+		{"jobs", "Maximum number of tools run at the same time.", "count", settings.value("BuildJobs", QThread::idealThreadCount()).toString()},
+		{"ignore-errors", "Keep building the steps that don't depend on a failed step."},
+		{"link-shards", "Number of linker runs the languages are split over with --lang all.", "count", settings.value("LinkShards", 1).toString()},
+		{"link-shard-jobs", "Maximum number of link shards run at the same time, 0 for no limit other than --jobs.", "count",
+		 settings.value("LinkShardJobs", 0).toString()},
+		{"benchmark-link", "Link everything once in a single linker run and once sharded, and report the time each took."},
+		{"force", "Run cached steps even if none of their inputs changed."},
+		{"benchmark-export2bin", "Convert the *_EXPORT files and folders given as arguments with 1 and with --workers workers and report the throughput of both."},
+		{"workers", "Number of files Export2Bin converts at the same time.", "count", settings.value("Export2Bin_Workers", QThread::idealThreadCount()).toString()},
+		{"stub", "Benchmark Export2Bin with a stub that copies its input instead of export2bin, to measure only the launcher."},
+		{"stub-latency", "Time the stub takes for each file in milliseconds.", "ms", "0"},
+		{"synthetic", "Benchmark Export2Bin on this many generated exports instead of files, implies --stub.", "count"},
+		{"synthetic-size", "Size of each generated export in KB.", "size", "256"},
+		{"benchmark-validator", "Validate the *_EXPORT files and folders given as arguments, or a large generated model without any, and report the throughput."},
+		{"benchmark-output", "Write lines to the build output from several threads at --lines-per-minute for --seconds and report what reaches the GUI."},
+		{"lines-per-minute", "Lines --benchmark-output writes a minute, 0 for as many as possible.", "count", "1000000"},
+		{"seconds", "How long --benchmark-output runs.", "seconds", "10"},
+		{"benchmark-log-parser", "Classify the lines of the logs and folders given as arguments, or the ones in logs, and report the throughput."},
+		{"benchmark-cancel", "Cancel a stub tool that started tools of its own and fail if the build isn't idle within --bound or any of them is left running."},
+		{"bound", "Longest time --benchmark-cancel may take from cancelling to idle in milliseconds.", "ms", "2000"}
+	});
+	parser.addPositionalArgument("files", "Files or folders for --benchmark-export2bin, --benchmark-validator and --benchmark-log-parser.", "[files...]");
+
+	if (!parser.parse(Arguments))
+	{
+		fprintf(stderr, "%s\n", qPrintable(parser.errorText()));
+		return ML_EXIT_USAGE;
+	}
+
+	if (parser.isSet("help"))
+	{
+		fprintf(stdout, "%s", qPrintable(parser.helpText()));
+		return ML_EXIT_SUCCESS;
+	}
+
+	if (parser.isSet("benchmark-export2bin"))
+	{
+		auto workersValid = false;
+		const auto workers = parser.value("workers").toInt(&workersValid);
+		if (!workersValid || workers < 1)
+		{
+			fprintf(stderr, "--workers must be a positive number\n");
+			return ML_EXIT_USAGE;
+		}
+
+		auto stubLatencyValid = false;
+		const auto stubLatency = parser.value("stub-latency").toInt(&stubLatencyValid);
+		if (!stubLatencyValid || stubLatency < 0)
+		{
+			fprintf(stderr, "--stub-latency must be 0 or more\n");
+			return ML_EXIT_USAGE;
+		}
+
+		if (!parser.isSet("synthetic"))
+			return BenchmarkExport2Bin(parser.positionalArguments(), workers, parser.isSet("stub"), stubLatency);
+
+		auto syntheticValid = false;
+		auto syntheticSizeValid = false;
+		const auto syntheticCount = parser.value("synthetic").toInt(&syntheticValid);
+		const auto syntheticSize = parser.value("synthetic-size").toLongLong(&syntheticSizeValid);
+		if (!syntheticValid || syntheticCount < 1 || !syntheticSizeValid || syntheticSize < 1)
+		{
+			fprintf(stderr, "--synthetic and --synthetic-size must be positive numbers\n");
+			return ML_EXIT_USAGE;
+		}
+
+		QTemporaryDir inputDir;
+		if (WriteSyntheticExports(inputDir.path(), syntheticCount, syntheticSize * 1024).isEmpty())
+		{
+			fprintf(stderr, "Could not write the generated exports to '%s'\n", qPrintable(inputDir.path()));
+			return ML_EXIT_BUILD_FAILED;
+		}
+
+		return BenchmarkExport2Bin(QStringList{inputDir.path()}, workers, true, stubLatency);
+	}
+
+	if (parser.isSet("benchmark-validator"))
+		return BenchmarkValidator(parser.positionalArguments());
+
+	if (parser.isSet("benchmark-log-parser"))
+		return BenchmarkLogParser(parser.positionalArguments());
+
+	if (parser.isSet("benchmark-cancel"))
+	{
+		auto boundValid = false;
+		const auto bound = parser.value("bound").toInt(&boundValid);
+		if (!boundValid || bound < 1)
+		{
+			fprintf(stderr, "--bound must be a positive number\n");
+			return ML_EXIT_USAGE;
+		}
+
+		return BenchmarkCancel(bound);
+	}
+
+	if (parser.isSet("benchmark-output"))
+	{
+		auto linesValid = false;
+		auto secondsValid = false;
+		const auto linesPerMinute = parser.value("lines-per-minute").toInt(&linesValid);
+		const auto seconds = parser.value("seconds").toInt(&secondsValid);
+		if (!linesValid || linesPerMinute < 0 || !secondsValid || seconds < 1)
+		{
+			fprintf(stderr, "--lines-per-minute must be 0 or more and --seconds a positive number\n");
+			return ML_EXIT_USAGE;
+		}
+
+		return BenchmarkOutput(linesPerMinute, seconds, 4);
+	}
+
+	auto options = mlBuildOptions{};
+	options.GamePath = getenv("TA_GAME_PATH");
+	options.ToolsPath = getenv("TA_TOOLS_PATH");
+
+	const auto userMapsFolder = QDir::cleanPath(QString("%1/usermaps/").arg(options.GamePath));
+	const auto modsFolder = QDir::cleanPath(QString("%1/mods/").arg(options.GamePath));
+
+	auto usage = [](const QString& Error)
+	{
+		fprintf(stderr, "%s\n", qPrintable(Error));
+		return ML_EXIT_USAGE;
+	};
+
+	auto maps = parser.values("map");
+	if (parser.isSet("all-maps"))
+		maps << QDir(userMapsFolder).entryList(QDir::AllDirs | QDir::NoDotAndDotDot);
+
+	for (const auto& mapName : maps)
+	{
+		if (!QFileInfo(QString("%1/%2/zone_source/%3.zone").arg(userMapsFolder, mapName, mapName)).isFile())
+		{
+			if (parser.isSet("all-maps"))
+				continue;
+
+			return usage(QString("Could not find the zone file for map '%1'").arg(mapName));
+		}
+
+		if (!options.Maps.contains(mapName))
+			options.Maps.append(mapName);
+	}
+
+	const char* modZones[4] = {"core_mod", "mp_mod", "cp_mod", "zm_mod"};
+
+	for (const auto& mod : parser.values("mod"))
+	{
+		const auto modName = mod.section('/', 0, 0);
+		auto zones = QStringList{};
+
+		if (mod.contains('/'))
+		{
+			zones.append(mod.section('/', 1));
+		}
+		else
+		{
+			for (const auto* zone : modZones)
+				zones.append(zone);
+		}
+
+		auto found = false;
+		for (const auto& zoneName : zones)
+		{
+			if (QFileInfo(QString("%1/%2/zone_source/%3.zone").arg(modsFolder, modName, zoneName)).isFile())
+			{
+				options.ModZones.append(QPair<QString, QString>(modName, zoneName));
+				found = true;
+			}
+		}
+
+		if (!found)
+			return usage(QString("Could not find any zone files for mod '%1'").arg(mod));
+	}
+
+	if (parser.isSet("compile"))
+	{
+		const auto mode = parser.value("compile").toLower();
+		if (mode != "ents" && mode != "full")
+			return usage("--compile must be either 'ents' or 'full'");
+
+		options.Compile = true;
+		options.CompileEntsOnly = mode == "ents";
+	}
+
+	if (parser.isSet("light"))
+	{
+		options.LightQuality = QStringList({"low", "medium", "high"}).indexOf(parser.value("light").toLower());
+		if (options.LightQuality == -1)
+			return usage("--light must be either 'low', 'medium' or 'high'");
+
+		options.Light = true;
+	}
+
+	options.Link = parser.isSet("link");
+	options.Language = parser.value("lang");
+
+	if (options.Language.compare("All", Qt::CaseInsensitive) == 0)
+	{
+		options.Language = "All";
+	}
+	else
+	{
+		auto known = false;
+		for (const auto* language : gLanguages)
+			known = known || options.Language == language;
+
+		if (!known)
+			return usage(QString("Unknown language '%1'").arg(options.Language));
+	}
+
+	auto jobsValid = false;
+	const auto jobs = parser.value("jobs").toInt(&jobsValid);
+	if (!jobsValid || jobs < 1)
+		return usage("--jobs must be a positive number");
+
+	auto shardsValid = false;
+	options.LinkShards = parser.value("link-shards").toInt(&shardsValid);
+	if (!shardsValid || options.LinkShards < 1)
+		return usage("--link-shards must be a positive number");
+
+	auto shardJobsValid = false;
+	options.LinkShardJobs = parser.value("link-shard-jobs").toInt(&shardJobsValid);
+	if (!shardJobsValid || options.LinkShardJobs < 0)
+		return usage("--link-shard-jobs must be 0 or a positive number");
+
+	const auto graph = mlBuildGraph::Create(options);
+	if (graph.IsEmpty())
+		return usage("Nothing to build, give at least one map or mod and one of --compile, --light or --link");
+
+	if (!parser.isSet("benchmark-link"))
+		return RunBuild(graph, jobs, parser.isSet("ignore-errors"), parser.isSet("force")) ? ML_EXIT_SUCCESS : ML_EXIT_BUILD_FAILED;
+
+	if (!options.Link || options.Language != "All")
+		return usage("--benchmark-link needs --link and --lang all");
+
+	// Both modes link everything from scratch, with the cache they would mostly measure how fast nothing happens
+	auto singleOptions = options;
+	singleOptions.LinkShards = 1;
+
+	auto shardedOptions = options;
+	shardedOptions.LinkShards = options.LinkShards > 1 ? options.LinkShards : static_cast<int>(std::size(gLanguages));
+
+	auto timer = QElapsedTimer{};
+	timer.start();
+	const auto singleSucceeded = RunBuild(mlBuildGraph::Create(singleOptions), jobs, false, true);
+	const auto singleTime = timer.elapsed();
+
+	if (!singleSucceeded)
+		return ML_EXIT_BUILD_FAILED;
+
+	timer.restart();
+	const auto shardedSucceeded = RunBuild(mlBuildGraph::Create(shardedOptions), jobs, false, true);
+	const auto shardedTime = timer.elapsed();
+
+	if (!shardedSucceeded)
+		return ML_EXIT_BUILD_FAILED;
+
+	const auto shardedMode = options.LinkShardJobs > 0
+		? QString("%1 shards, %2 at once").arg(shardedOptions.LinkShards).arg(options.LinkShardJobs)
+		: QString("%1 shards").arg(shardedOptions.LinkShards);
+
+	fprintf(stdout, "\nLink benchmark with %d build jobs:\n", jobs);
+	fprintf(stdout, "  single linker run: %lld ms\n", static_cast<long long>(singleTime));
+	fprintf(stdout, "  %s: %lld ms\n", qPrintable(shardedMode), static_cast<long long>(shardedTime));
+	fprintf(stdout, "Set \"Link Shards\" to %d in the options for the faster mode on this machine\n",
+	        shardedTime < singleTime ? shardedOptions.LinkShards : 1);
+	fflush(stdout);
+
+	return ML_EXIT_SUCCESS;
+}
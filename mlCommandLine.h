@@ -0,0 +1,11 @@
+#pragma once
+
+// Headless builds, e.g. "ModLauncher --build --map zm_foo --compile full --light high --link --lang all --jobs 8".
+// Runs on a QCoreApplication without creating any widgets or initializing Steam and streams the build output to stdout.
+// "--benchmark-export2bin <files or folders> --workers 16" compares converting with one worker against converting with 16.
+class mlCommandLine
+{
+public:
+	static bool IsHeadless(int argc, char* argv[]);
+	static int Exec(const QStringList& Arguments);
+};
@@ -0,0 +1,263 @@
+#include "stdafx.h"
+
+#include <algorithm>
+
+#ifdef Q_OS_WIN
+#include <Windows.h>
+#else
+#include <unistd.h>
+#endif
+
+// Results are evicted, least recently used first, once they take up more than this
+static const qint64 gMaxCacheSize = qint64{2} * 1024 * 1024 * 1024;
+static const int gIndexLockTimeout = 10000;
+
+static QJsonObject LoadIndex(const QString& Folder)
+{
+	auto file = QFile{Folder + "/index.json"};
+	if (!file.open(QIODevice::ReadOnly))
+		return QJsonObject{};
+
+	return QJsonDocument::fromJson(file.readAll()).object();
+}
+
+mlConvertCache::mlConvertCache(const QString& ConverterPath)
+	: mFolder(FolderPath())
+{
+	const auto index = LoadIndex(mFolder);
+	mInputs = index["Inputs"].toObject();
+	mTargets = index["Targets"].toObject();
+
+	mConverterHash = InputHash(ConverterPath);
+}
+
+QString mlConvertCache::FolderPath()
+{
+	return QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation) + "/export2bin_cache";
+}
+
+QString mlConvertCache::Key(const QString& InputPath)
+{
+	const auto inputHash = InputHash(InputPath);
+	if (inputHash.isEmpty())
+		return QString();
+
+	auto hash = QCryptographicHash{QCryptographicHash::Md5};
+	hash.addData(mConverterHash);
+	hash.addData(inputHash);
+	return hash.result().toHex();
+}
+
+bool mlConvertCache::IsUpToDate(const QString& TargetPath, const QString& Key) const
+{
+	QMutexLocker locker(&mMutex);
+	const auto target = mTargets[QDir::cleanPath(TargetPath)].toArray();
+	const auto fileInfo = QFileInfo{TargetPath};
+
+	return target.count() == 3 && target[0].toString() == Key && fileInfo.isFile() &&
+		target[1].toDouble() == fileInfo.size() && target[2].toDouble() == fileInfo.lastModified().toMSecsSinceEpoch();
+}
+
+bool mlConvertCache::Knows(const QString& TargetPath) const
+{
+	QMutexLocker locker(&mMutex);
+	return mTargets.contains(QDir::cleanPath(TargetPath));
+}
+
+bool mlConvertCache::Restore(const QString& Key, const QString& TargetPath)
+{
+	const auto resultPath = ResultPath(Key, TargetPath);
+	if (!QFileInfo(resultPath).isFile() || !LinkOrCopy(resultPath, TargetPath))
+		return false;
+
+	Use(resultPath);
+	Record(Key, TargetPath);
+	return true;
+}
+
+void mlConvertCache::Store(const QString& Key, const QString& TargetPath)
+{
+	const auto resultPath = ResultPath(Key, TargetPath);
+	if (!QFileInfo(resultPath).isFile())
+	{
+		QDir{}.mkpath(QFileInfo(resultPath).absolutePath());
+		LinkOrCopy(TargetPath, resultPath);
+	}
+
+	if (QFileInfo(resultPath).isFile())
+		Use(resultPath);
+
+	Record(Key, TargetPath);
+}
+
+void mlConvertCache::Save()
+{
+	QMutexLocker locker(&mMutex);
+	QDir{}.mkpath(mFolder);
+
+	// Other batches save the same index, possibly from another launcher, what they added since we loaded it is kept
+	QLockFile lock(mFolder + "/index.lock");
+	if (!lock.tryLock(gIndexLockTimeout))
+		return;
+
+	const auto index = LoadIndex(mFolder);
+	auto inputs = index["Inputs"].toObject();
+	auto targets = index["Targets"].toObject();
+	auto results = index["Results"].toObject();
+
+	// Caches written before results were tracked still have to be evicted eventually
+	if (!index.contains("Results"))
+	{
+		QDirIterator it(mFolder, QDir::Files, QDirIterator::Subdirectories);
+		while (it.hasNext())
+		{
+			it.next();
+			const auto fileInfo = it.fileInfo();
+			const auto resultPath = it.filePath().mid(mFolder.size() + 1);
+			if (resultPath.contains('/'))
+				results[resultPath] = QJsonArray{static_cast<double>(fileInfo.size()), static_cast<double>(fileInfo.lastModified().toMSecsSinceEpoch())};
+		}
+	}
+
+	for (auto it = mNewInputs.begin(); it != mNewInputs.end(); ++it)
+		inputs[it.key()] = it.value();
+
+	for (auto it = mNewTargets.begin(); it != mNewTargets.end(); ++it)
+		targets[it.key()] = it.value();
+
+	for (auto it = mUsedResults.begin(); it != mUsedResults.end(); ++it)
+	{
+		const auto previous = results[it.key()].toArray();
+		if (previous.count() != 2 || previous[1].toDouble() < it.value().toArray()[1].toDouble())
+			results[it.key()] = it.value();
+	}
+
+	auto forgetMissing = [](QJsonObject& Files, const QString& Prefix)
+	{
+		for (auto it = Files.begin(); it != Files.end();)
+		{
+			if (QFileInfo::exists(Prefix + it.key()))
+				++it;
+			else
+				it = Files.erase(it);
+		}
+	};
+
+	forgetMissing(inputs, QString());
+	forgetMissing(targets, QString());
+	forgetMissing(results, mFolder + '/');
+
+	auto totalSize = qint64{0};
+	auto byLastUse = QVector<QPair<double, QString>>{};
+	for (auto it = results.begin(); it != results.end(); ++it)
+	{
+		const auto result = it.value().toArray();
+		totalSize += static_cast<qint64>(result[0].toDouble());
+		byLastUse.append(qMakePair(result[1].toDouble(), it.key()));
+	}
+
+	// Targets linked to an evicted result keep their contents, only converting the same input again gets slower
+	std::sort(byLastUse.begin(), byLastUse.end());
+	for (const auto& result : byLastUse)
+	{
+		if (totalSize <= gMaxCacheSize)
+			break;
+
+		if (QFile::remove(mFolder + '/' + result.second))
+		{
+			totalSize -= static_cast<qint64>(results[result.second].toArray()[0].toDouble());
+			results.remove(result.second);
+		}
+	}
+
+	auto merged = QJsonObject{};
+	merged["Inputs"] = inputs;
+	merged["Targets"] = targets;
+	merged["Results"] = results;
+
+	auto file = QSaveFile{mFolder + "/index.json"};
+	if (!file.open(QIODevice::WriteOnly))
+		return;
+
+	file.write(QJsonDocument(merged).toJson(QJsonDocument::Compact));
+	if (!file.commit())
+		return;
+
+	mInputs = inputs;
+	mTargets = targets;
+	mNewInputs = QJsonObject{};
+	mNewTargets = QJsonObject{};
+	mUsedResults = QJsonObject{};
+}
+
+QString mlConvertCache::ResultPath(const QString& Key, const QString& TargetPath) const
+{
+	return QString("%1/%2/%3.%4").arg(mFolder, Key.left(2), Key, QFileInfo(TargetPath).suffix());
+}
+
+QByteArray mlConvertCache::InputHash(const QString& Path)
+{
+	const auto fileInfo = QFileInfo{Path};
+	if (!fileInfo.isFile())
+		return QByteArray();
+
+	const auto filePath = QDir::cleanPath(fileInfo.absoluteFilePath());
+	const auto size = fileInfo.size();
+	const auto time = fileInfo.lastModified().toMSecsSinceEpoch();
+
+	{
+		QMutexLocker locker(&mMutex);
+		const auto previous = mInputs[filePath].toArray();
+		if (previous.count() == 3 && previous[0].toDouble() == size && previous[1].toDouble() == time)
+			return previous[2].toString().toLatin1();
+	}
+
+	// Hashing doesn't hold the lock, other threads keep going meanwhile
+	const auto hash = mlBuildCache::HashFile(filePath).toHex();
+	if (!hash.isEmpty())
+	{
+		const auto input = QJsonArray{static_cast<double>(size), static_cast<double>(time), QString::fromLatin1(hash)};
+
+		QMutexLocker locker(&mMutex);
+		mInputs[filePath] = input;
+		mNewInputs[filePath] = input;
+	}
+
+	return hash;
+}
+
+void mlConvertCache::Record(const QString& Key, const QString& TargetPath)
+{
+	const auto fileInfo = QFileInfo{TargetPath};
+	const auto target = QJsonArray{Key, static_cast<double>(fileInfo.size()), static_cast<double>(fileInfo.lastModified().toMSecsSinceEpoch())};
+
+	QMutexLocker locker(&mMutex);
+	mTargets[QDir::cleanPath(TargetPath)] = target;
+	mNewTargets[QDir::cleanPath(TargetPath)] = target;
+}
+
+void mlConvertCache::Use(const QString& ResultPath)
+{
+	const auto result = QJsonArray{static_cast<double>(QFileInfo(ResultPath).size()),
+	                               static_cast<double>(QDateTime::currentMSecsSinceEpoch())};
+
+	QMutexLocker locker(&mMutex);
+	mUsedResults[ResultPath.mid(mFolder.size() + 1)] = result;
+}
+
+bool mlConvertCache::LinkOrCopy(const QString& From, const QString& To)
+{
+	QFile::remove(To);
+
+	// Conversions always replace their output with a new file, so a linked file is never modified in place
+#ifdef Q_OS_WIN
+	if (CreateHardLinkW(reinterpret_cast<LPCWSTR>(QDir::toNativeSeparators(To).utf16()),
+	                    reinterpret_cast<LPCWSTR>(QDir::toNativeSeparators(From).utf16()), nullptr))
+		return true;
+#else
+	if (link(QFile::encodeName(From).constData(), QFile::encodeName(To).constData()) == 0)
+		return true;
+#endif
+
+	return QFile::copy(From, To);
+}
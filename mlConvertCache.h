@@ -0,0 +1,50 @@
+#pragma once
+
+// Export2Bin results keyed by the hash of the input file and of export2bin.exe itself. Every output file written by a
+// conversion is recorded with the key it was converted from, so an unchanged input is skipped without converting and
+// a changed one is always converted again. Results are stored once and hard linked (or copied) wherever they're needed.
+// One instance can be used from several threads. Batches running at the same time each have their own instance, Save()
+// merges what this one learned into the index on disk instead of replacing it.
+class mlConvertCache
+{
+public:
+	explicit mlConvertCache(const QString& ConverterPath);
+
+	static QString FolderPath();
+
+	// Empty if the input can't be read
+	QString Key(const QString& InputPath);
+
+	// The target still is exactly what the key converted to
+	bool IsUpToDate(const QString& TargetPath, const QString& Key) const;
+
+	// The target was written by a conversion, as opposed to a file we know nothing about
+	bool Knows(const QString& TargetPath) const;
+
+	bool Restore(const QString& Key, const QString& TargetPath);
+	void Store(const QString& Key, const QString& TargetPath);
+
+	// Also forgets inputs and targets that were deleted and evicts the least recently used results once the cache
+	// grows past its size limit
+	void Save();
+
+protected:
+	QString ResultPath(const QString& Key, const QString& TargetPath) const;
+	QByteArray InputHash(const QString& Path);
+	void Record(const QString& Key, const QString& TargetPath);
+	void Use(const QString& ResultPath);
+
+	static bool LinkOrCopy(const QString& From, const QString& To);
+
+	QString mFolder;
+	QByteArray mConverterHash;
+
+	mutable QMutex mMutex;
+	QJsonObject mInputs;  // Path -> [size, modification time, hash], so unchanged inputs aren't hashed again
+	QJsonObject mTargets; // Path -> [key, size, modification time]
+
+	// What this instance added since it was loaded, Save() applies only these on top of the index on disk
+	QJsonObject mNewInputs;
+	QJsonObject mNewTargets;
+	QJsonObject mUsedResults; // Result path relative to the folder -> [size, last use]
+};
@@ -0,0 +1,152 @@
+#include "stdafx.h"
+
+#ifdef Q_OS_WIN
+#include <Windows.h>
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+mlConvertBatch mlConvertBatch::Remaining() const
+{
+	auto batch = mlConvertBatch{};
+	batch.OutputDir = OutputDir;
+	batch.Overwrite = Overwrite;
+	batch.Finished = false;
+
+	for (auto fileIdx = 0; fileIdx < Files.count(); fileIdx++)
+	{
+		if (Converted.value(fileIdx))
+			continue;
+
+		batch.Files.append(Files[fileIdx]);
+		if (!OutputDirs.isEmpty())
+			batch.OutputDirs.append(OutputDirs[fileIdx]);
+	}
+
+	batch.Converted.fill(false, batch.Files.count());
+	return batch;
+}
+
+mlConvertJournal::mlConvertJournal()
+	: mUnsynced(0)
+{
+}
+
+mlConvertJournal::~mlConvertJournal()
+{
+	Sync();
+}
+
+QString mlConvertJournal::FilePath()
+{
+	return QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation) + "/export2bin_journal.txt";
+}
+
+mlConvertBatch mlConvertJournal::Load()
+{
+	auto batch = mlConvertBatch{};
+	batch.Overwrite = false;
+	batch.Finished = true;
+
+	auto file = QFile{FilePath()};
+	if (!file.open(QIODevice::ReadOnly))
+		return batch;
+
+	// A line without its line break was cut short by a crash and is ignored
+	auto line = file.readLine();
+	if (!line.startsWith("B ") || !line.endsWith('\n'))
+		return batch;
+
+	const auto object = QJsonDocument::fromJson(line.mid(2)).object();
+	for (const auto& filePath : object["Files"].toArray())
+		batch.Files.append(filePath.toString());
+	for (const auto& outputDir : object["OutputDirs"].toArray())
+		batch.OutputDirs.append(outputDir.toString());
+	batch.OutputDir = object["OutputDir"].toString();
+	batch.Overwrite = object["Overwrite"].toBool();
+	batch.Converted.fill(false, batch.Files.count());
+	batch.Finished = false;
+
+	if (!batch.OutputDirs.isEmpty() && batch.OutputDirs.count() != batch.Files.count())
+		batch.OutputDirs.clear();
+
+	while (!file.atEnd())
+	{
+		line = file.readLine();
+		if (!line.endsWith('\n'))
+			break;
+
+		if (line.startsWith("E"))
+		{
+			batch.Finished = true;
+			continue;
+		}
+
+		const auto fileIdx = line.mid(2).trimmed().toInt();
+		if (fileIdx >= 0 && fileIdx < batch.Files.count())
+			batch.Converted[fileIdx] = line.startsWith("C ");
+	}
+
+	return batch;
+}
+
+bool mlConvertJournal::Begin(const mlConvertBatch& Batch)
+{
+	auto object = QJsonObject{};
+	object["Files"] = QJsonArray::fromStringList(Batch.Files);
+	object["OutputDirs"] = QJsonArray::fromStringList(Batch.OutputDirs);
+	object["OutputDir"] = Batch.OutputDir;
+	object["Overwrite"] = Batch.Overwrite;
+
+	const auto filePath = FilePath();
+	QDir{}.mkpath(QFileInfo(filePath).absolutePath());
+
+	mFile.setFileName(filePath);
+	if (!mFile.open(QIODevice::WriteOnly | QIODevice::Truncate))
+		return false;
+
+	mFile.write("B " + QJsonDocument(object).toJson(QJsonDocument::Compact) + '\n');
+	mUnsynced = 1;
+	Sync();
+	return true;
+}
+
+void mlConvertJournal::Record(int FileIdx, bool Converted)
+{
+	if (!mFile.isOpen())
+		return;
+
+	mFile.write((Converted ? "C " : "F ") + QByteArray::number(FileIdx) + '\n');
+	mUnsynced++;
+
+	// Syncing every record would cost more than converting small files
+	if (mUnsynced >= 64 || mSyncTimer.elapsed() >= 1000)
+		Sync();
+}
+
+void mlConvertJournal::Finish()
+{
+	if (!mFile.isOpen())
+		return;
+
+	mFile.write("E\n");
+	mUnsynced++;
+	Sync();
+}
+
+void mlConvertJournal::Sync()
+{
+	if (!mFile.isOpen() || mUnsynced == 0)
+		return;
+
+	mFile.flush();
+#ifdef Q_OS_WIN
+	FlushFileBuffers(reinterpret_cast<HANDLE>(_get_osfhandle(mFile.handle())));
+#else
+	fsync(mFile.handle());
+#endif
+
+	mUnsynced = 0;
+	mSyncTimer.start();
+}
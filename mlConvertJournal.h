@@ -0,0 +1,49 @@
+#pragma once
+
+// An Export2Bin batch as it was started and, when loaded back from the journal, how far it got
+struct mlConvertBatch
+{
+	QStringList Files;
+	QStringList OutputDirs; // One for each file, or empty if they all go to OutputDir
+	QString OutputDir;
+	bool Overwrite;
+
+	QVector<bool> Converted; // Converted or skipped, failed files and files that never finished are converted again
+	bool Finished;           // Every file was dealt with, there's nothing to resume
+
+	int RemainingCount() const
+	{
+		return static_cast<int>(Converted.count(false));
+	}
+
+	// The files that weren't converted yet as a batch of their own
+	mlConvertBatch Remaining() const;
+};
+
+// Journal of the last Export2Bin batch, so a batch that was cancelled or cut short by a crash can be resumed. The batch
+// is written on one line when it starts and every file that finishes appends a few bytes after it. The file is only
+// appended to and synced every so many records, a crash loses at most the files that finished since the last sync and
+// those are converted again.
+class mlConvertJournal
+{
+public:
+	mlConvertJournal();
+	~mlConvertJournal();
+
+	static QString FilePath();
+
+	// Files is empty if there is no journal
+	static mlConvertBatch Load();
+
+	// Replaces the previous journal
+	bool Begin(const mlConvertBatch& Batch);
+	void Record(int FileIdx, bool Converted);
+	void Finish();
+
+protected:
+	void Sync();
+
+	QFile mFile;
+	int mUnsynced;
+	QElapsedTimer mSyncTimer;
+};
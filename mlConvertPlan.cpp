@@ -0,0 +1,77 @@
+#include "stdafx.h"
+
+mlConvertPlan mlConvertPlan::Create(const QList<QUrl>& Urls, const QString& OutputDir, bool MirrorFolders)
+{
+	auto plan = mlConvertPlan{};
+	plan.TotalSize = 0;
+	plan.Ignored = 0;
+	plan.Duplicates = 0;
+
+	const auto outputDir = QDir::cleanPath(OutputDir);
+
+	auto sources = QSet<QString>{};
+	auto targets = QSet<QString>{};
+
+	// Paths are compared case insensitively, Windows wouldn't tell them apart either
+	auto addFile = [&](const QFileInfo& FileInfo, const QString& TargetDir)
+	{
+		const auto suffix = FileInfo.suffix().toUpper();
+		if (suffix != "XMODEL_EXPORT" && suffix != "XANIM_EXPORT")
+		{
+			plan.Ignored++;
+			return;
+		}
+
+		const auto source = QDir::cleanPath(FileInfo.absoluteFilePath()).toLower();
+		const auto target = (TargetDir + '/' + FileInfo.baseName() + '.' + suffix).toLower();
+		if (sources.contains(source) || targets.contains(target))
+		{
+			plan.Duplicates++;
+			return;
+		}
+
+		sources.insert(source);
+		targets.insert(target);
+
+		plan.Files.append(FileInfo.absoluteFilePath());
+		plan.OutputDirs.append(TargetDir);
+		plan.TotalSize += FileInfo.size();
+	};
+
+	for (const auto& url : Urls)
+	{
+		const auto fileInfo = QFileInfo{url.toLocalFile()};
+
+		if (fileInfo.isFile())
+		{
+			addFile(fileInfo, outputDir);
+			continue;
+		}
+
+		if (!fileInfo.isDir())
+			continue;
+
+		const auto root = QDir{fileInfo.absoluteFilePath()};
+		QDirIterator it(root.absolutePath(), QDir::Files, QDirIterator::Subdirectories);
+		while (it.hasNext())
+		{
+			it.next();
+			const auto relativeDir = root.relativeFilePath(it.fileInfo().absolutePath());
+			addFile(it.fileInfo(), MirrorFolders && relativeDir != "." ? QDir::cleanPath(outputDir + '/' + relativeDir) : outputDir);
+		}
+	}
+
+	return plan;
+}
+
+QString mlConvertPlan::Summary() const
+{
+	auto summary = QString("Export2Bin: %1 files to convert (%2 MB)").arg(Files.count()).arg(TotalSize / (1024.0 * 1024.0), 0, 'f', 1);
+
+	if (Ignored > 0)
+		summary += QString(", %1 files that aren't exports ignored").arg(Ignored);
+	if (Duplicates > 0)
+		summary += QString(", %1 duplicates ignored").arg(Duplicates);
+
+	return summary;
+}
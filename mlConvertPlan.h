@@ -0,0 +1,19 @@
+#pragma once
+
+// The files a drop on the Export2Bin dock converts and the folder each of them is converted into. Dropped folders are
+// searched recursively and everything that isn't an export is left out, as are files dropped more than once or that
+// would be converted to the same output as a file before them.
+struct mlConvertPlan
+{
+	QStringList Files;
+	QStringList OutputDirs; // One for each file
+	qint64 TotalSize;
+
+	int Ignored;    // Files that aren't *.XMODEL_EXPORT or *.XANIM_EXPORT
+	int Duplicates; // Files that were dropped more than once or collide with the output of another file
+
+	// With MirrorFolders files found in a dropped folder keep their path relative to it below the output folder
+	static mlConvertPlan Create(const QList<QUrl>& Urls, const QString& OutputDir, bool MirrorFolders);
+
+	QString Summary() const;
+};
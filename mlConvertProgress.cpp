@@ -0,0 +1,148 @@
+#include "stdafx.h"
+
+#include <cmath>
+
+static QString FormatDuration(qint64 Milliseconds)
+{
+	const auto seconds = Milliseconds / 1000;
+	if (seconds >= 3600)
+		return QString("%1:%2:%3").arg(seconds / 3600).arg(seconds / 60 % 60, 2, 10, QChar('0')).arg(seconds % 60, 2, 10, QChar('0'));
+	return QString("%1:%2").arg(seconds / 60).arg(seconds % 60, 2, 10, QChar('0'));
+}
+
+QString mlConvertStats::Text() const
+{
+	auto text = QString("%1/%2 files, %3 of %4 MB").arg(DoneFiles).arg(TotalFiles).arg(DoneBytes / (1024.0 * 1024.0), 0, 'f', 1)
+		.arg(TotalBytes / (1024.0 * 1024.0), 0, 'f', 1);
+
+	if (FailedFiles > 0)
+		text += QString(", %1 failed").arg(FailedFiles);
+
+	text += QString("\n%1 files/s, %2 MB/s").arg(FilesPerSecond, 0, 'f', 1).arg(BytesPerSecond / (1024.0 * 1024.0), 0, 'f', 1);
+	if (Eta >= 0 && DoneFiles < TotalFiles)
+		text += ", ETA " + FormatDuration(Eta);
+
+	if (LatencyMax >= 0)
+		text += QString("\nLatency: p50 %1 ms, p95 %2 ms, max %3 ms").arg(LatencyP50).arg(LatencyP95).arg(LatencyMax);
+
+	return text;
+}
+
+mlConvertProgress::mlConvertProgress()
+	: mTotalFiles(0), mDoneFiles(0), mFailedFiles(0), mTotalBytes(0), mDoneBytes(0), mLatencyMax(-1), mStartTime(-1)
+{
+	for (auto& bucket : mLatencyBuckets)
+		bucket = 0;
+
+	mTimer.start();
+}
+
+void mlConvertProgress::Start(int TotalFiles, qint64 TotalBytes)
+{
+	mTotalFiles = TotalFiles;
+	mTotalBytes = TotalBytes;
+	mStartTime = mTimer.elapsed();
+}
+
+void mlConvertProgress::FileFinished(qint64 Bytes, bool Failed, qint64 Latency)
+{
+	if (Latency >= 0)
+	{
+		mLatencyBuckets[LatencyBucket(Latency)]++;
+
+		auto latencyMax = mLatencyMax.load();
+		while (Latency > latencyMax && !mLatencyMax.compare_exchange_weak(latencyMax, Latency))
+		{
+		}
+	}
+
+	if (Failed)
+		mFailedFiles++;
+
+	// Bytes first, so the reader never sees a file as done without its size
+	mDoneBytes += Bytes;
+	mDoneFiles++;
+}
+
+mlConvertStats mlConvertProgress::Stats(qint64 RateWindow)
+{
+	auto stats = mlConvertStats{};
+	stats.TotalFiles = mTotalFiles;
+	stats.DoneFiles = mDoneFiles;
+	stats.FailedFiles = mFailedFiles;
+	stats.TotalBytes = mTotalBytes;
+	stats.DoneBytes = mDoneBytes;
+	stats.FilesPerSecond = 0.0;
+	stats.BytesPerSecond = 0.0;
+	stats.Eta = -1;
+	stats.LatencyP50 = Percentile(50);
+	stats.LatencyP95 = Percentile(95);
+	stats.LatencyMax = mLatencyMax;
+
+	const auto startTime = mStartTime.load();
+	const auto now = mTimer.elapsed();
+	stats.Elapsed = startTime >= 0 ? now - startTime : 0;
+
+	auto first = mlSample{startTime, 0, 0};
+	if (RateWindow > 0)
+	{
+		mSamples.append(mlSample{now, stats.DoneFiles, stats.DoneBytes});
+		while (mSamples.count() > 1 && mSamples[1].Time <= now - RateWindow)
+			mSamples.removeFirst();
+
+		// Until the window filled up once the whole batch is all there is
+		if (mSamples.first().Time <= now - RateWindow)
+			first = mSamples.first();
+	}
+
+	const auto span = now - first.Time;
+	if (startTime < 0 || span <= 0)
+		return stats;
+
+	stats.FilesPerSecond = (stats.DoneFiles - first.Files) * 1000.0 / span;
+	stats.BytesPerSecond = (stats.DoneBytes - first.Bytes) * 1000.0 / span;
+
+	// Bytes are the better measure as long as files vary in size, but skipped files are done without reading anything
+	if (stats.BytesPerSecond > 0.0)
+		stats.Eta = static_cast<qint64>((stats.TotalBytes - stats.DoneBytes) * 1000.0 / stats.BytesPerSecond);
+	else if (stats.FilesPerSecond > 0.0)
+		stats.Eta = static_cast<qint64>((stats.TotalFiles - stats.DoneFiles) * 1000.0 / stats.FilesPerSecond);
+
+	return stats;
+}
+
+int mlConvertProgress::LatencyBucket(qint64 Latency)
+{
+	const auto bucket = static_cast<int>(4.0 * std::log2(static_cast<double>(Latency) + 1.0));
+	return qBound(0, bucket, static_cast<int>(ML_LATENCY_BUCKETS) - 1);
+}
+
+qint64 mlConvertProgress::BucketLimit(int Bucket)
+{
+	return static_cast<qint64>(std::ceil(std::exp2((Bucket + 1) / 4.0))) - 1;
+}
+
+qint64 mlConvertProgress::Percentile(int Percent) const
+{
+	auto buckets = QVector<int>(ML_LATENCY_BUCKETS);
+	auto total = qint64{0};
+	for (auto bucketIdx = 0; bucketIdx < ML_LATENCY_BUCKETS; bucketIdx++)
+	{
+		buckets[bucketIdx] = mLatencyBuckets[bucketIdx];
+		total += buckets[bucketIdx];
+	}
+
+	if (total == 0)
+		return -1;
+
+	const auto target = (total * Percent + 99) / 100;
+	auto count = qint64{0};
+	for (auto bucketIdx = 0; bucketIdx < ML_LATENCY_BUCKETS; bucketIdx++)
+	{
+		count += buckets[bucketIdx];
+		if (count >= target)
+			return qMin(BucketLimit(bucketIdx), mLatencyMax.load());
+	}
+
+	return mLatencyMax;
+}
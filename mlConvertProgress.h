@@ -0,0 +1,68 @@
+#pragma once
+
+struct mlConvertStats
+{
+	int TotalFiles;
+	int DoneFiles; // Including the failed ones
+	int FailedFiles;
+	qint64 TotalBytes;
+	qint64 DoneBytes;
+	qint64 Elapsed; // Milliseconds
+
+	double FilesPerSecond;
+	double BytesPerSecond;
+	qint64 Eta; // Milliseconds, -1 until there's a rate to go by
+
+	// Milliseconds from starting the converter until it finished, -1 until a file was converted
+	qint64 LatencyP50;
+	qint64 LatencyP95;
+	qint64 LatencyMax;
+
+	QString Text() const;
+};
+
+// Counters a conversion updates as files finish and the GUI reads while it runs. The conversion side only touches
+// atomics, latencies go into a histogram with four buckets per power of two, so percentiles are within 20% or so.
+class mlConvertProgress
+{
+public:
+	mlConvertProgress();
+
+	void Start(int TotalFiles, qint64 TotalBytes);
+
+	// Latency is -1 for files that weren't handed to the converter, they don't count towards the percentiles
+	void FileFinished(qint64 Bytes, bool Failed, qint64 Latency);
+
+	// Rates and the ETA are taken over the last RateWindow milliseconds, or the whole batch with RateWindow 0. The
+	// window is kept by the reader, only one thread should ask for rolling stats.
+	mlConvertStats Stats(qint64 RateWindow = 30000);
+
+protected:
+	enum
+	{
+		ML_LATENCY_BUCKETS = 96
+	};
+
+	static int LatencyBucket(qint64 Latency);
+	static qint64 BucketLimit(int Bucket);
+	qint64 Percentile(int Percent) const;
+
+	std::atomic<int> mTotalFiles;
+	std::atomic<int> mDoneFiles;
+	std::atomic<int> mFailedFiles;
+	std::atomic<qint64> mTotalBytes;
+	std::atomic<qint64> mDoneBytes;
+	std::atomic<qint64> mLatencyMax;
+	std::atomic<int> mLatencyBuckets[ML_LATENCY_BUCKETS];
+
+	QElapsedTimer mTimer;           // Started on construction and only read after that, so both sides can use it
+	std::atomic<qint64> mStartTime; // mTimer when the conversion started, -1 before that
+
+	struct mlSample
+	{
+		qint64 Time;
+		int Files;
+		qint64 Bytes;
+	};
+	QList<mlSample> mSamples;
+};
@@ -0,0 +1,261 @@
+#include "stdafx.h"
+
+#if defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define ML_SSE2
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+#include <climits>
+#include <cstring>
+
+#ifdef ML_SSE2
+static int FirstSetBit(int Mask)
+{
+#ifdef _MSC_VER
+	auto bit = 0ul;
+	_BitScanForward(&bit, static_cast<unsigned long>(Mask));
+	return static_cast<int>(bit);
+#else
+	return __builtin_ctz(static_cast<unsigned int>(Mask));
+#endif
+}
+#endif
+
+// Returns the first '\n' or NUL at or after Begin, or End if there is none
+static const char* FindBreak(const char* Begin, const char* End)
+{
+	const auto* it = Begin;
+
+#ifdef ML_SSE2
+	const auto newlines = _mm_set1_epi8('\n');
+	const auto zeros = _mm_setzero_si128();
+
+	while (End - it >= 16)
+	{
+		const auto chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(it));
+		const auto mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(chunk, newlines), _mm_cmpeq_epi8(chunk, zeros)));
+		if (mask != 0)
+			return it + FirstSetBit(mask);
+
+		it += 16;
+	}
+#endif
+
+	while (it < End && *it != '\n' && *it != '\0')
+		it++;
+
+	return it;
+}
+
+// The length is known at compile time, so most lines are turned away by a single comparison
+template <size_t Length>
+static bool IsKeyword(const char* Begin, const char* End, const char (&Keyword)[Length])
+{
+	return End - Begin == static_cast<qint64>(Length - 1) && memcmp(Begin, Keyword, Length - 1) == 0;
+}
+
+// Numbers are parsed by hand, the mapped file isn't null terminated
+static int ParseCount(const char* Begin, const char* End)
+{
+	while (Begin < End && (*Begin == ' ' || *Begin == '\t'))
+		Begin++;
+
+	if (Begin == End || *Begin < '0' || *Begin > '9')
+		return -1;
+
+	auto count = qint64{0};
+	while (Begin < End && *Begin >= '0' && *Begin <= '9' && count <= INT_MAX)
+		count = count * 10 + (*Begin++ - '0');
+
+	return count <= INT_MAX ? static_cast<int>(count) : -1;
+}
+
+mlExportInfo mlExportValidator::Validate(const QString& FilePath)
+{
+	const auto animation = QFileInfo(FilePath).suffix().compare("XANIM_EXPORT", Qt::CaseInsensitive) == 0;
+
+	auto file = QFile{FilePath};
+	if (!file.open(QIODevice::ReadOnly))
+	{
+		auto info = Validate(nullptr, 0, animation);
+		info.Error = "could not open the file";
+		return info;
+	}
+
+	const auto size = file.size();
+	if (size == 0)
+		return Validate(nullptr, 0, animation);
+
+	const auto* data = file.map(0, size);
+	if (data != nullptr)
+		return Validate(reinterpret_cast<const char*>(data), size, animation);
+
+	// Some file systems can't be mapped
+	const auto contents = file.readAll();
+	return Validate(contents.constData(), contents.size(), animation);
+}
+
+mlExportInfo mlExportValidator::Validate(const char* Data, qint64 Size, bool Animation)
+{
+	auto info = mlExportInfo{};
+	info.Size = Size;
+	info.Bones = -1;
+	info.Verts = -1;
+	info.Faces = -1;
+	info.Parts = -1;
+	info.Frames = -1;
+
+	if (Size == 0)
+	{
+		info.Error = "the file is empty";
+		return info;
+	}
+
+	auto version = -1;
+	auto objects = -1;
+	auto materials = -1;
+	auto frameRate = -1;
+
+	auto vertCount = 0;
+	auto faceCount = 0;
+	auto objectCount = 0;
+	auto materialCount = 0;
+	auto frameCount = 0;
+	auto framePartCount = qint64{0};
+
+	auto header = false;
+	auto inFaces = false;
+
+	const auto* end = Data + Size;
+	for (const auto* lineBegin = Data; lineBegin < end;)
+	{
+		const auto* lineEnd = FindBreak(lineBegin, end);
+		if (lineEnd < end && *lineEnd == '\0')
+		{
+			info.Error = "the file contains NUL bytes, it isn't a text export";
+			return info;
+		}
+
+		const auto* keyword = lineBegin;
+		lineBegin = lineEnd + 1;
+
+		while (keyword < lineEnd && (*keyword == ' ' || *keyword == '\t'))
+			keyword++;
+
+		// Every keyword is upper case, this skips blank lines, comments and the rest of a value split over lines
+		if (keyword == lineEnd || *keyword < 'A' || *keyword > 'Z')
+			continue;
+
+		const auto* keywordEnd = keyword;
+		while (keywordEnd < lineEnd && *keywordEnd != ' ' && *keywordEnd != '\t' && *keywordEnd != '\r')
+			keywordEnd++;
+
+		if (!header)
+		{
+			if (Animation ? !IsKeyword(keyword, keywordEnd, "ANIMATION") : !IsKeyword(keyword, keywordEnd, "MODEL"))
+			{
+				info.Error = QString("the file doesn't start with %1").arg(Animation ? "ANIMATION" : "MODEL");
+				return info;
+			}
+
+			header = true;
+			continue;
+		}
+
+		if (IsKeyword(keyword, keywordEnd, "VERSION"))
+			version = ParseCount(keywordEnd, lineEnd);
+		else if (Animation)
+		{
+			if (IsKeyword(keyword, keywordEnd, "PART"))
+			{
+				if (frameCount > 0)
+					framePartCount++;
+			}
+			else if (IsKeyword(keyword, keywordEnd, "FRAME"))
+				frameCount++;
+			else if (IsKeyword(keyword, keywordEnd, "NUMPARTS"))
+				info.Parts = ParseCount(keywordEnd, lineEnd);
+			else if (IsKeyword(keyword, keywordEnd, "NUMFRAMES"))
+				info.Frames = ParseCount(keywordEnd, lineEnd);
+			else if (IsKeyword(keyword, keywordEnd, "FRAMERATE"))
+				frameRate = ParseCount(keywordEnd, lineEnd);
+		}
+		else
+		{
+			// Every face repeats VERT for its three corners, only the ones before the faces define vertices
+			if (IsKeyword(keyword, keywordEnd, "VERT") || IsKeyword(keyword, keywordEnd, "VERT32"))
+			{
+				if (!inFaces)
+					vertCount++;
+			}
+			else if (IsKeyword(keyword, keywordEnd, "TRI") || IsKeyword(keyword, keywordEnd, "TRI16"))
+				faceCount++;
+			else if (IsKeyword(keyword, keywordEnd, "OBJECT"))
+				objectCount++;
+			else if (IsKeyword(keyword, keywordEnd, "MATERIAL"))
+				materialCount++;
+			else if (IsKeyword(keyword, keywordEnd, "NUMBONES"))
+				info.Bones = ParseCount(keywordEnd, lineEnd);
+			else if (IsKeyword(keyword, keywordEnd, "NUMVERTS") || IsKeyword(keyword, keywordEnd, "NUMVERTS32"))
+				info.Verts = ParseCount(keywordEnd, lineEnd);
+			else if (IsKeyword(keyword, keywordEnd, "NUMFACES"))
+			{
+				info.Faces = ParseCount(keywordEnd, lineEnd);
+				inFaces = true;
+			}
+			else if (IsKeyword(keyword, keywordEnd, "NUMOBJECTS"))
+				objects = ParseCount(keywordEnd, lineEnd);
+			else if (IsKeyword(keyword, keywordEnd, "NUMMATERIALS"))
+				materials = ParseCount(keywordEnd, lineEnd);
+		}
+	}
+
+	auto missing = QStringList{};
+	if (version < 0)
+		missing << "VERSION";
+
+	if (Animation)
+	{
+		if (info.Parts < 0)
+			missing << "NUMPARTS";
+		if (frameRate < 0)
+			missing << "FRAMERATE";
+		if (info.Frames < 0)
+			missing << "NUMFRAMES";
+	}
+	else
+	{
+		if (info.Bones < 0)
+			missing << "NUMBONES";
+		if (info.Verts < 0)
+			missing << "NUMVERTS";
+		if (info.Faces < 0)
+			missing << "NUMFACES";
+		if (objects < 0)
+			missing << "NUMOBJECTS";
+		if (materials < 0)
+			missing << "NUMMATERIALS";
+	}
+
+	if (!header)
+		info.Error = "the file has no header";
+	else if (!missing.isEmpty())
+		info.Error = QString("there is no %1, the file is incomplete").arg(missing.join(", "));
+	else if (Animation && (frameCount < info.Frames || framePartCount < static_cast<qint64>(info.Frames) * info.Parts))
+	{
+		const auto completeFrames = info.Parts > 0 ? qMin<qint64>(frameCount, framePartCount / info.Parts) : frameCount;
+		info.Error = QString("only %1 of %2 frames are complete, the file is truncated").arg(completeFrames).arg(info.Frames);
+	}
+	else if (!Animation && vertCount < info.Verts)
+		info.Error = QString("only %1 of %2 vertices are there, the file is truncated").arg(vertCount).arg(info.Verts);
+	else if (!Animation && faceCount < info.Faces)
+		info.Error = QString("only %1 of %2 faces are there, the file is truncated").arg(faceCount).arg(info.Faces);
+	else if (!Animation && (objectCount < objects || materialCount < materials))
+		info.Error = "objects or materials are missing, the file is truncated";
+
+	return info;
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+// What the validator found in a *.XMODEL_EXPORT or *.XANIM_EXPORT file, the counts are the ones the file declares
+struct mlExportInfo
+{
+	qint64 Size;
+	int Bones;
+	int Verts;
+	int Faces;
+	int Parts;
+	int Frames;
+
+	QString Error; // Empty if the file looks complete
+
+	bool IsValid() const
+	{
+		return Error.isEmpty();
+	}
+};
+
+// Checks exports before they're handed to export2bin, a broken file is rejected without starting a process for it. The
+// file is memory mapped and scanned for line breaks 16 bytes at a time, only the keyword at the start of each line is
+// looked at. Files that aren't text, don't start with the right header, are missing one of the counts or have fewer
+// entries than they declare, which is what an export that was cut short looks like, are rejected.
+class mlExportValidator
+{
+public:
+	static mlExportInfo Validate(const QString& FilePath);
+	static mlExportInfo Validate(const char* Data, qint64 Size, bool Animation);
+};
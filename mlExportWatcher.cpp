@@ -0,0 +1,87 @@
+#include "stdafx.h"
+
+mlExportWatcher::mlExportWatcher(QObject* Parent) : QObject(Parent)
+{
+	// Exporters write in bursts, one scan after things calmed down is enough
+	mDebounceTimer.setSingleShot(true);
+	mDebounceTimer.setInterval(300);
+
+	// A file counts as complete once it looked the same on two scans this far apart
+	mSettleTimer.setSingleShot(true);
+	mSettleTimer.setInterval(1000);
+
+	connect(&mWatcher, SIGNAL(directoryChanged(QString)), &mDebounceTimer, SLOT(start()));
+	connect(&mDebounceTimer, SIGNAL(timeout()), this, SLOT(Scan()));
+	connect(&mSettleTimer, SIGNAL(timeout()), this, SLOT(Scan()));
+}
+
+bool mlExportWatcher::Start(const QString& Folder)
+{
+	Stop();
+
+	const auto folder = QDir::cleanPath(Folder);
+	if (!QFileInfo(folder).isDir() || !mWatcher.addPath(folder))
+		return false;
+
+	mFolder = folder;
+	Scan();
+	return true;
+}
+
+void mlExportWatcher::Stop()
+{
+	if (!mWatcher.directories().isEmpty())
+		mWatcher.removePaths(mWatcher.directories());
+
+	mDebounceTimer.stop();
+	mSettleTimer.stop();
+	mFolder.clear();
+	mReported.clear();
+	mSettling.clear();
+}
+
+void mlExportWatcher::Scan()
+{
+	if (mFolder.isEmpty())
+		return;
+
+	auto ready = QStringList{};
+	auto present = QSet<QString>{};
+
+	QDirIterator it(mFolder, QStringList() << "*.XMODEL_EXPORT" << "*.XANIM_EXPORT", QDir::Files);
+	while (it.hasNext())
+	{
+		const auto filePath = it.next();
+		const auto fileInfo = it.fileInfo();
+		const auto state = mlFileState{fileInfo.size(), fileInfo.lastModified().toMSecsSinceEpoch()};
+		present.insert(filePath);
+
+		if (mReported.contains(filePath) && mReported[filePath] == state)
+		{
+			mSettling.remove(filePath);
+			continue;
+		}
+
+		if (mSettling.contains(filePath) && mSettling[filePath] == state)
+		{
+			mSettling.remove(filePath);
+			mReported[filePath] = state;
+			ready.append(filePath);
+			continue;
+		}
+
+		mSettling[filePath] = state;
+	}
+
+	// Deleted files are forgotten so they're converted again if they come back
+	for (auto stateIt = mReported.begin(); stateIt != mReported.end();)
+		stateIt = present.contains(stateIt.key()) ? std::next(stateIt) : mReported.erase(stateIt);
+	for (auto stateIt = mSettling.begin(); stateIt != mSettling.end();)
+		stateIt = present.contains(stateIt.key()) ? std::next(stateIt) : mSettling.erase(stateIt);
+
+	if (!mSettling.isEmpty())
+		mSettleTimer.start();
+
+	if (!ready.isEmpty())
+		emit FilesReady(ready);
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+// Watches a folder for *.XMODEL_EXPORT and *.XANIM_EXPORT files that are new or changed. Change notifications are
+// debounced and a file is only reported once its size and modification time stopped changing, so files that are still
+// being exported aren't picked up half written. Nothing runs between changes.
+class mlExportWatcher : public QObject
+{
+	Q_OBJECT
+
+public:
+	explicit mlExportWatcher(QObject* Parent = nullptr);
+
+	// Every export already in the folder is reported once when watching starts, the conversion cache skips the ones
+	// that didn't change since they were last converted
+	bool Start(const QString& Folder);
+	void Stop();
+
+	bool IsWatching() const
+	{
+		return !mFolder.isEmpty();
+	}
+
+signals:
+	void FilesReady(const QStringList& Files);
+
+protected slots:
+	void Scan();
+
+protected:
+	struct mlFileState
+	{
+		qint64 Size;
+		qint64 Time;
+
+		bool operator==(const mlFileState& Other) const
+		{
+			return Size == Other.Size && Time == Other.Time;
+		}
+	};
+
+	QFileSystemWatcher mWatcher;
+	QTimer mDebounceTimer;
+	QTimer mSettleTimer;
+	QString mFolder;
+
+	QHash<QString, mlFileState> mReported;
+	QHash<QString, mlFileState> mSettling;
+};
@@ -0,0 +1,131 @@
+#include "stdafx.h"
+
+#ifdef Q_OS_WIN
+#include <Windows.h>
+#else
+#include <unistd.h>
+#endif
+
+static const qint64 gMegabyte = 1024 * 1024;
+
+mlResourceLimits mlResourceLimits::FromSettings()
+{
+	const auto settings = QSettings{};
+
+	auto limits = mlResourceLimits{};
+	limits.Cores = settings.value("GovernorCores", QThread::idealThreadCount()).toDouble();
+	limits.Memory = settings.value("GovernorMemory", PhysicalMemory() * 3 / 4 / gMegabyte).toLongLong() * gMegabyte;
+	limits.LowPriority = settings.value("LowToolPriority", true).toBool();
+	return limits;
+}
+
+qint64 mlResourceLimits::PhysicalMemory()
+{
+#ifdef Q_OS_WIN
+	auto status = MEMORYSTATUSEX{};
+	status.dwLength = sizeof(status);
+	if (GlobalMemoryStatusEx(&status))
+		return static_cast<qint64>(status.ullTotalPhys);
+#else
+	const auto pages = sysconf(_SC_PHYS_PAGES);
+	const auto pageSize = sysconf(_SC_PAGESIZE);
+	if (pages > 0 && pageSize > 0)
+		return static_cast<qint64>(pages) * pageSize;
+#endif
+
+	return 8192 * gMegabyte;
+}
+
+mlGovernor::mlGovernor(const mlResourceLimits& Limits)
+	: mLimits(Limits), mInUse{0, 0}, mAdmitted(0)
+{
+	// The most expensive of the last 10 successful runs, a tool that needed that much once will need it again. The last
+	// 2000 steps hold plenty of runs of every tool a build uses.
+	auto runs = QHash<QString, int>{};
+	const auto records = mlBuildHistory::Load(2000);
+
+	for (auto recordIdx = records.count() - 1; recordIdx >= 0; recordIdx--)
+	{
+		const auto& record = records[recordIdx];
+		if (record.ExitCode != 0)
+			continue;
+
+		const auto key = CostKey(record.Tool, record.Arguments);
+		if (runs[key]++ >= 10)
+			continue;
+
+		auto& cost = mLearnedCosts[key];
+		if (record.PeakMemory > 0)
+			cost.Memory = qMax(cost.Memory, record.PeakMemory);
+		if (record.CpuTime > 0 && record.Duration > 0)
+			cost.Cores = qMax(cost.Cores, static_cast<double>(record.CpuTime) / record.Duration);
+	}
+}
+
+bool mlGovernor::Governs(const mlBuildStep& Step)
+{
+	return !Step.Program.isEmpty() && QFileInfo(Step.Program).completeBaseName().compare("BlackOps3", Qt::CaseInsensitive) != 0;
+}
+
+mlToolCost mlGovernor::Cost(const mlBuildStep& Step) const
+{
+	if (!Governs(Step))
+		return mlToolCost{0, 0};
+
+	const auto key = CostKey(QFileInfo(Step.Program).completeBaseName(), Step.Arguments);
+	auto cost = DeclaredCost(key);
+
+	const auto learned = mLearnedCosts.value(key, mlToolCost{0, 0});
+	if (learned.Cores > 0)
+		cost.Cores = learned.Cores;
+	if (learned.Memory > 0)
+		cost.Memory = learned.Memory;
+
+	// A tool can't need more than everything
+	cost.Cores = qMin(cost.Cores, mLimits.Cores);
+	cost.Memory = qMin(cost.Memory, mLimits.Memory);
+	return cost;
+}
+
+bool mlGovernor::Admits(const mlToolCost& Cost) const
+{
+	if (mAdmitted == 0)
+		return true;
+
+	return mInUse.Cores + Cost.Cores <= mLimits.Cores + 0.01 && mInUse.Memory + Cost.Memory <= mLimits.Memory;
+}
+
+void mlGovernor::Acquire(const mlToolCost& Cost)
+{
+	mInUse.Cores += Cost.Cores;
+	mInUse.Memory += Cost.Memory;
+	mAdmitted++;
+}
+
+void mlGovernor::Release(const mlToolCost& Cost)
+{
+	mInUse.Cores = qMax(mInUse.Cores - Cost.Cores, 0.0);
+	mInUse.Memory = qMax(mInUse.Memory - Cost.Memory, qint64{0});
+	mAdmitted--;
+}
+
+QString mlGovernor::CostKey(const QString& Tool, const QStringList& Arguments)
+{
+	// Compiling the navmesh costs a lot more than only compiling the entities
+	const auto key = Tool.toLower();
+	return Arguments.contains("-navmesh") ? key + " -navmesh" : key;
+}
+
+mlToolCost mlGovernor::DeclaredCost(const QString& Key)
+{
+	if (Key == "cod2map64 -navmesh")
+		return mlToolCost{4, 4096 * gMegabyte};
+	if (Key == "cod2map64")
+		return mlToolCost{1, 1024 * gMegabyte};
+	if (Key == "radiant_modtools")
+		return mlToolCost{static_cast<double>(QThread::idealThreadCount()), 6144 * gMegabyte};
+	if (Key == "linker_modtools")
+		return mlToolCost{1, 2048 * gMegabyte};
+
+	return mlToolCost{1, 512 * gMegabyte};
+}
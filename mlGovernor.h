@@ -0,0 +1,55 @@
+#pragma once
+
+struct mlToolCost
+{
+	double Cores;
+	qint64 Memory; // Bytes
+};
+
+struct mlResourceLimits
+{
+	double Cores;
+	qint64 Memory; // Bytes
+	bool LowPriority;
+
+	// "GovernorCores", "GovernorMemory" (MB) and "LowToolPriority", defaults to every core and 3/4 of the physical memory
+	static mlResourceLimits FromSettings();
+	static qint64 PhysicalMemory();
+};
+
+// Admits tools into the build only while the cores and memory they need fit into what's left of the budget. A tool's
+// cost is learned from the peak memory and CPU time its recent runs recorded in the build history and falls back to a
+// declared estimate until there are any. Whatever runs alone is always admitted so oversized tools can't stall a build.
+class mlGovernor
+{
+public:
+	explicit mlGovernor(const mlResourceLimits& Limits);
+
+	const mlResourceLimits& Limits() const
+	{
+		return mLimits;
+	}
+
+	// Only the tools are governed, the game is started as it is
+	static bool Governs(const mlBuildStep& Step);
+
+	mlToolCost Cost(const mlBuildStep& Step) const;
+	bool Admits(const mlToolCost& Cost) const;
+
+	void Acquire(const mlToolCost& Cost);
+	void Release(const mlToolCost& Cost);
+
+	mlToolCost InUse() const
+	{
+		return mInUse;
+	}
+
+protected:
+	static QString CostKey(const QString& Tool, const QStringList& Arguments);
+	static mlToolCost DeclaredCost(const QString& Key);
+
+	mlResourceLimits mLimits;
+	mlToolCost mInUse;
+	int mAdmitted;
+	QHash<QString, mlToolCost> mLearnedCosts;
+};
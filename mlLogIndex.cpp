@@ -0,0 +1,498 @@
+#include "stdafx.h"
+
+#include <algorithm>
+#include <cstring>
+#include <string_view>
+
+// A segment is this header, the UTF-8 path of the log, the offset of every block in the log, the dictionary sorted by
+// word, the words themselves and the postings. Postings are the blocks a word appears in as varint encoded deltas. The
+// sections after the path start at multiples of 8 so the file can be read in place.
+struct mlSegmentHeader
+{
+	char Magic[4];
+	quint32 Version;
+	qint64 LogSize;
+	qint64 LogModified; // Milliseconds since the epoch
+	quint32 LineCount;
+	quint32 BlockCount;
+	quint32 TokenCount;
+	quint32 LogPathSize;
+	qint64 BlocksOffset;
+	qint64 TokensOffset;
+	qint64 StringsOffset;
+	qint64 PostingsOffset;
+};
+
+struct mlSegmentToken
+{
+	quint32 StringOffset;
+	quint32 StringSize;
+	quint32 PostingsOffset;
+	quint32 PostingsSize;
+};
+
+static const char gSegmentMagic[4] = {'M', 'L', 'L', 'I'};
+static const quint32 gSegmentVersion = 1;
+
+static bool IsWordChar(char Char)
+{
+	const auto lower = Char | 0x20;
+	return (lower >= 'a' && lower <= 'z') || (Char >= '0' && Char <= '9') || Char == '_' || static_cast<unsigned char>(Char) >= 0x80;
+}
+
+static char ToLower(char Char)
+{
+	return Char >= 'A' && Char <= 'Z' ? static_cast<char>(Char + ('a' - 'A')) : Char;
+}
+
+static void AppendVarint(QByteArray& Data, quint32 Value)
+{
+	while (Value >= 0x80)
+	{
+		Data.append(static_cast<char>(Value | 0x80));
+		Value >>= 7;
+	}
+
+	Data.append(static_cast<char>(Value));
+}
+
+// Adds the blocks in the postings to Blocks, which stays sorted
+static void ReadPostings(const uchar* Begin, const uchar* End, QVector<quint32>& Blocks)
+{
+	auto block = quint32{0};
+	while (Begin < End)
+	{
+		auto delta = quint32{0};
+		auto shift = 0;
+		while (Begin < End && (*Begin & 0x80) != 0 && shift < 28)
+		{
+			delta |= static_cast<quint32>(*Begin++ & 0x7f) << shift;
+			shift += 7;
+		}
+		if (Begin < End)
+			delta |= static_cast<quint32>(*Begin++) << shift;
+
+		block += delta;
+		Blocks.append(block);
+	}
+}
+
+static qint64 Align(qint64 Offset)
+{
+	return (Offset + 7) & ~qint64{7};
+}
+
+static bool ReadHeader(QFile& Segment, mlSegmentHeader& Header, QString& LogPath)
+{
+	if (Segment.read(reinterpret_cast<char*>(&Header), sizeof(Header)) != sizeof(Header))
+		return false;
+
+	if (memcmp(Header.Magic, gSegmentMagic, sizeof(gSegmentMagic)) != 0 || Header.Version != gSegmentVersion)
+		return false;
+
+	LogPath = QString::fromUtf8(Segment.read(Header.LogPathSize));
+	return !LogPath.isEmpty();
+}
+
+mlLogIndex::mlLogIndex(const QString& IndexPath)
+	: mIndexPath(IndexPath)
+{
+}
+
+QString mlLogIndex::DefaultPath()
+{
+	return QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation) + "/log_index";
+}
+
+QString mlLogIndex::SegmentPath(const QString& LogPath) const
+{
+	return mIndexPath + '/' + QCryptographicHash::hash(LogPath.toUtf8(), QCryptographicHash::Md5).toHex() + ".idx";
+}
+
+int mlLogIndex::Update(const QString& LogsPath, const QStringList& ExcludedFiles, const std::function<bool()>& Cancelled)
+{
+	QDir{}.mkpath(mIndexPath);
+
+	auto excludedFiles = QSet<QString>{};
+	for (const auto& excludedFile : ExcludedFiles)
+		excludedFiles.insert(QFileInfo(excludedFile).absoluteFilePath());
+
+	auto segmentPaths = QSet<QString>{};
+	auto indexedCount = 0;
+
+	QDirIterator it(LogsPath, QStringList() << "*.txt" << "*.log", QDir::Files, QDirIterator::Subdirectories);
+	while (it.hasNext())
+	{
+		if (Cancelled())
+			return indexedCount;
+
+		const auto logInfo = QFileInfo(it.next());
+		const auto logPath = logInfo.absoluteFilePath();
+		const auto segmentPath = SegmentPath(logPath);
+		segmentPaths.insert(segmentPath);
+
+		// A log that's still being written keeps the segment it had, if it had one
+		if (excludedFiles.contains(logPath))
+			continue;
+
+		auto segment = QFile{segmentPath};
+		auto header = mlSegmentHeader{};
+		auto segmentLogPath = QString{};
+		if (segment.open(QIODevice::ReadOnly) && ReadHeader(segment, header, segmentLogPath) && segmentLogPath == logPath &&
+		    header.LogSize == logInfo.size() && header.LogModified == logInfo.lastModified().toMSecsSinceEpoch())
+			continue;
+		segment.close();
+
+		auto newSegment = QSaveFile{segmentPath};
+		if (!newSegment.open(QIODevice::WriteOnly) || !IndexLog(logPath, newSegment, Cancelled))
+			continue;
+
+		// Only replacing the segment has to wait for searches, building it doesn't
+		const QWriteLocker lock(&mLock);
+		if (newSegment.commit())
+			indexedCount++;
+	}
+
+	if (Cancelled())
+		return indexedCount;
+
+	const QWriteLocker lock(&mLock);
+
+	const auto segmentInfos = QDir{mIndexPath}.entryInfoList(QStringList() << "*.idx", QDir::Files);
+	for (const auto& segmentInfo : segmentInfos)
+	{
+		if (!segmentPaths.contains(segmentInfo.absoluteFilePath()))
+			QFile::remove(segmentInfo.absoluteFilePath());
+	}
+
+	return indexedCount;
+}
+
+bool mlLogIndex::IndexLog(const QString& LogPath, QSaveFile& Segment, const std::function<bool()>& Cancelled)
+{
+	auto log = QFile{LogPath};
+	if (!log.open(QIODevice::ReadOnly))
+		return false;
+
+	const auto logSize = log.size();
+	const auto logModified = QFileInfo(log).lastModified().toMSecsSinceEpoch();
+
+	const auto* data = logSize > 0 ? reinterpret_cast<const char*>(log.map(0, logSize)) : "";
+	if (data == nullptr)
+		return false;
+
+	auto postings = QHash<QByteArray, QVector<quint32>>{};
+	auto blocks = QVector<qint64>{0};
+	char token[ML_MAX_TOKEN_LENGTH];
+
+	const auto* it = data;
+	const auto* end = data + logSize;
+	auto line = quint32{0};
+
+	while (it < end)
+	{
+		if (*it == '\n')
+		{
+			it++;
+			line++;
+
+			if (line % ML_LINES_PER_BLOCK == 0 && it < end)
+			{
+				blocks.append(it - data);
+
+				if (line % (ML_LINES_PER_BLOCK * 1024) == 0 && Cancelled())
+					return false;
+			}
+
+			continue;
+		}
+
+		if (!IsWordChar(*it))
+		{
+			it++;
+			continue;
+		}
+
+		const auto* wordBegin = it;
+		while (it < end && IsWordChar(*it))
+			it++;
+
+		const auto wordSize = it - wordBegin;
+		if (wordSize < ML_MIN_TOKEN_LENGTH || wordSize > ML_MAX_TOKEN_LENGTH)
+			continue;
+
+		for (auto charIdx = 0; charIdx < wordSize; charIdx++)
+			token[charIdx] = ToLower(wordBegin[charIdx]);
+
+		// Looked up without a copy, only a word that's new to this log is copied
+		const auto block = line / ML_LINES_PER_BLOCK;
+		auto posting = postings.find(QByteArray::fromRawData(token, static_cast<int>(wordSize)));
+		if (posting == postings.end())
+			posting = postings.insert(QByteArray(token, static_cast<int>(wordSize)), QVector<quint32>());
+
+		if (posting->isEmpty() || posting->last() != block)
+			posting->append(block);
+	}
+
+	const auto lineCount = line + (logSize > 0 && data[logSize - 1] != '\n' ? 1 : 0);
+
+	auto words = postings.keys();
+	std::sort(words.begin(), words.end());
+
+	auto tokens = QVector<mlSegmentToken>{};
+	auto strings = QByteArray{};
+	auto postingData = QByteArray{};
+	tokens.reserve(words.count());
+
+	for (const auto& word : words)
+	{
+		auto token = mlSegmentToken{};
+		token.StringOffset = static_cast<quint32>(strings.size());
+		token.StringSize = static_cast<quint32>(word.size());
+		token.PostingsOffset = static_cast<quint32>(postingData.size());
+		strings.append(word);
+
+		auto previousBlock = quint32{0};
+		for (const auto block : postings[word])
+		{
+			AppendVarint(postingData, block - previousBlock);
+			previousBlock = block;
+		}
+
+		token.PostingsSize = static_cast<quint32>(postingData.size()) - token.PostingsOffset;
+		tokens.append(token);
+	}
+
+	const auto logPath = LogPath.toUtf8();
+
+	auto header = mlSegmentHeader{};
+	memcpy(header.Magic, gSegmentMagic, sizeof(gSegmentMagic));
+	header.Version = gSegmentVersion;
+	header.LogSize = logSize;
+	header.LogModified = logModified;
+	header.LineCount = lineCount;
+	header.BlockCount = static_cast<quint32>(blocks.count());
+	header.TokenCount = static_cast<quint32>(tokens.count());
+	header.LogPathSize = static_cast<quint32>(logPath.size());
+	header.BlocksOffset = Align(sizeof(header) + logPath.size());
+	header.TokensOffset = Align(header.BlocksOffset + blocks.count() * sizeof(qint64));
+	header.StringsOffset = header.TokensOffset + tokens.count() * sizeof(mlSegmentToken);
+	header.PostingsOffset = header.StringsOffset + strings.size();
+
+	auto write = [&Segment](const void* Data, qint64 Size, qint64 Offset)
+	{
+		const auto padding = QByteArray(static_cast<int>(Offset - Segment.pos()), '\0');
+		Segment.write(padding);
+		Segment.write(static_cast<const char*>(Data), Size);
+	};
+
+	write(&header, sizeof(header), 0);
+	write(logPath.constData(), logPath.size(), sizeof(header));
+	write(blocks.constData(), blocks.count() * sizeof(qint64), header.BlocksOffset);
+	write(tokens.constData(), tokens.count() * sizeof(mlSegmentToken), header.TokensOffset);
+	write(strings.constData(), strings.size(), header.StringsOffset);
+	write(postingData.constData(), postingData.size(), header.PostingsOffset);
+
+	return Segment.error() == QFileDevice::NoError;
+}
+
+QList<mlLogMatch> mlLogIndex::Search(const QString& Query, int MaxMatches) const
+{
+	auto matches = QList<mlLogMatch>{};
+
+	auto query = Query.toUtf8();
+	for (auto& queryChar : query)
+		queryChar = ToLower(queryChar);
+
+	// Every word is looked up as it is, except the last one, which could still be cut short
+	struct mlQueryWord
+	{
+		QByteArray Word;
+		bool Prefix;
+	};
+
+	auto words = QList<mlQueryWord>{};
+	for (auto charIdx = 0; charIdx < query.size();)
+	{
+		if (!IsWordChar(query.at(charIdx)))
+		{
+			charIdx++;
+			continue;
+		}
+
+		const auto wordBegin = charIdx;
+		while (charIdx < query.size() && IsWordChar(query.at(charIdx)))
+			charIdx++;
+
+		const auto wordSize = charIdx - wordBegin;
+		if (wordSize >= ML_MIN_TOKEN_LENGTH && wordSize <= ML_MAX_TOKEN_LENGTH)
+			words.append(mlQueryWord{query.mid(wordBegin, wordSize), charIdx == query.size()});
+	}
+
+	if (words.isEmpty())
+		return matches;
+
+	const QReadLocker lock(&mLock);
+
+	// Oldest logs first, so the first match is where something first showed up
+	struct mlSegmentFile
+	{
+		QString SegmentPath;
+		QString LogPath;
+		qint64 LogModified;
+	};
+
+	auto segmentFiles = QList<mlSegmentFile>{};
+	for (const auto& segmentInfo : QDir{mIndexPath}.entryInfoList(QStringList() << "*.idx", QDir::Files))
+	{
+		auto segment = QFile{segmentInfo.absoluteFilePath()};
+		auto header = mlSegmentHeader{};
+		auto logPath = QString{};
+		if (segment.open(QIODevice::ReadOnly) && ReadHeader(segment, header, logPath))
+			segmentFiles.append(mlSegmentFile{segment.fileName(), logPath, header.LogModified});
+	}
+
+	std::sort(segmentFiles.begin(), segmentFiles.end(), [](const mlSegmentFile& Left, const mlSegmentFile& Right)
+	{
+		return Left.LogModified < Right.LogModified;
+	});
+
+	const auto queryView = std::string_view(query.constData(), query.size());
+	auto lowerLine = QByteArray{};
+
+	for (const auto& segmentFile : segmentFiles)
+	{
+		auto segment = QFile{segmentFile.SegmentPath};
+		if (!segment.open(QIODevice::ReadOnly) || segment.size() < static_cast<qint64>(sizeof(mlSegmentHeader)))
+			continue;
+
+		const auto* segmentData = segment.map(0, segment.size());
+		if (segmentData == nullptr)
+			continue;
+
+		const auto& header = *reinterpret_cast<const mlSegmentHeader*>(segmentData);
+		if (header.PostingsOffset > segment.size())
+			continue;
+
+		const auto* blockOffsets = reinterpret_cast<const qint64*>(segmentData + header.BlocksOffset);
+		const auto* tokens = reinterpret_cast<const mlSegmentToken*>(segmentData + header.TokensOffset);
+		const auto* strings = reinterpret_cast<const char*>(segmentData + header.StringsOffset);
+		const auto* postings = segmentData + header.PostingsOffset;
+
+		auto tokenWord = [&](const mlSegmentToken& Token)
+		{
+			return std::string_view(strings + Token.StringOffset, Token.StringSize);
+		};
+
+		// Blocks that have every word, narrowed down one word at a time
+		auto candidates = QVector<quint32>{};
+		for (auto wordIdx = 0; wordIdx < words.count(); wordIdx++)
+		{
+			const auto word = std::string_view(words[wordIdx].Word.constData(), words[wordIdx].Word.size());
+			const auto* token = std::lower_bound(tokens, tokens + header.TokenCount, word, [&](const mlSegmentToken& Token, std::string_view Word)
+			{
+				return tokenWord(Token) < Word;
+			});
+
+			auto blocks = QVector<quint32>{};
+			for (; token < tokens + header.TokenCount; token++)
+			{
+				const auto tokenString = tokenWord(*token);
+				if (words[wordIdx].Prefix ? tokenString.compare(0, word.size(), word) != 0 : tokenString != word)
+					break;
+
+				ReadPostings(postings + token->PostingsOffset, postings + token->PostingsOffset + token->PostingsSize, blocks);
+				if (!words[wordIdx].Prefix)
+					break;
+			}
+
+			if (words[wordIdx].Prefix)
+			{
+				std::sort(blocks.begin(), blocks.end());
+				blocks.erase(std::unique(blocks.begin(), blocks.end()), blocks.end());
+			}
+
+			if (wordIdx == 0)
+				candidates = blocks;
+			else
+			{
+				auto intersection = QVector<quint32>{};
+				std::set_intersection(candidates.begin(), candidates.end(), blocks.begin(), blocks.end(), std::back_inserter(intersection));
+				candidates = intersection;
+			}
+
+			if (candidates.isEmpty())
+				break;
+		}
+
+		if (candidates.isEmpty())
+			continue;
+
+		// Only the candidate blocks are read from the log, and only if it didn't change since it was indexed
+		auto log = QFile{segmentFile.LogPath};
+		if (!log.open(QIODevice::ReadOnly) || log.size() < header.LogSize || header.LogSize == 0)
+			continue;
+
+		const auto* logData = reinterpret_cast<const char*>(log.map(0, header.LogSize));
+		if (logData == nullptr)
+			continue;
+
+		const auto modified = QDateTime::fromMSecsSinceEpoch(header.LogModified);
+
+		for (const auto block : candidates)
+		{
+			if (block >= header.BlockCount)
+				break;
+
+			const auto blockEnd = block + 1 < header.BlockCount ? blockOffsets[block + 1] : header.LogSize;
+			auto lineBegin = blockOffsets[block];
+			auto line = static_cast<qint64>(block) * ML_LINES_PER_BLOCK;
+
+			while (lineBegin < blockEnd)
+			{
+				const auto* newline = static_cast<const char*>(memchr(logData + lineBegin, '\n', blockEnd - lineBegin));
+				const auto lineEnd = newline != nullptr ? newline - logData : blockEnd;
+
+				lowerLine.resize(static_cast<int>(lineEnd - lineBegin));
+				for (auto charIdx = 0; charIdx < lowerLine.size(); charIdx++)
+					lowerLine[charIdx] = ToLower(logData[lineBegin + charIdx]);
+
+				if (std::string_view(lowerLine.constData(), lowerLine.size()).find(queryView) != std::string_view::npos)
+				{
+					auto text = QString::fromUtf8(logData + lineBegin, static_cast<int>(lineEnd - lineBegin));
+					if (text.endsWith('\r'))
+						text.chop(1);
+
+					matches.append(mlLogMatch{segmentFile.LogPath, modified, line, text});
+					if (matches.count() >= MaxMatches)
+						return matches;
+				}
+
+				lineBegin = lineEnd + 1;
+				line++;
+			}
+		}
+	}
+
+	return matches;
+}
+
+void mlLogIndex::Stats(int& LogCount, qint64& LogSize) const
+{
+	LogCount = 0;
+	LogSize = 0;
+
+	const QReadLocker lock(&mLock);
+
+	for (const auto& segmentInfo : QDir{mIndexPath}.entryInfoList(QStringList() << "*.idx", QDir::Files))
+	{
+		auto segment = QFile{segmentInfo.absoluteFilePath()};
+		auto header = mlSegmentHeader{};
+		auto logPath = QString{};
+		if (segment.open(QIODevice::ReadOnly) && ReadHeader(segment, header, logPath))
+		{
+			LogCount++;
+			LogSize += header.LogSize;
+		}
+	}
+}
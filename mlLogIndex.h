@@ -0,0 +1,52 @@
+#pragma once
+
+struct mlLogMatch
+{
+	QString FilePath;
+	QDateTime Modified;
+	qint64 Line; // 0 based
+	QString Text;
+};
+
+// Inverted index over the logs in logs/, for finding which builds printed something. Every log gets a segment of its
+// own in the index folder that maps each word to the blocks of 64 lines it appears in, so a new log only means a new
+// segment and the others stay as they are. A search looks the words up in every segment and only reads the blocks that
+// have all of them from the logs. Segments are memory mapped while searching, only their dictionary and the postings of
+// the searched words are touched.
+class mlLogIndex
+{
+public:
+	explicit mlLogIndex(const QString& IndexPath = DefaultPath());
+
+	static QString DefaultPath();
+
+	// Indexes the logs under LogsPath that are new or changed since the last update and drops the segments of the ones
+	// that are gone, ExcludedFiles are skipped. Returns the number of logs that were indexed. Can run on any thread, and
+	// returns early once Cancelled returns true.
+	int Update(const QString& LogsPath, const QStringList& ExcludedFiles, const std::function<bool()>& Cancelled);
+
+	// Lines that have Query in them, ignoring case. The index only finds text that starts at the beginning of a word.
+	// Oldest log first, at most MaxMatches of them.
+	QList<mlLogMatch> Search(const QString& Query, int MaxMatches) const;
+
+	// The number of logs and the total size of them that are in the index
+	void Stats(int& LogCount, qint64& LogSize) const;
+
+protected:
+	enum
+	{
+		ML_LINES_PER_BLOCK = 64,
+		ML_MIN_TOKEN_LENGTH = 2,
+		ML_MAX_TOKEN_LENGTH = 64
+	};
+
+	// Writes the segment of a log, committing it is left to the caller
+	static bool IndexLog(const QString& LogPath, QSaveFile& Segment, const std::function<bool()>& Cancelled);
+	QString SegmentPath(const QString& LogPath) const;
+
+	QString mIndexPath;
+
+	// Searches hold it for reading, an update only for writing while it replaces or removes a segment, which can't be
+	// done to a file that's mapped on Windows
+	mutable QReadWriteLock mLock;
+};
@@ -0,0 +1,255 @@
+#include "stdafx.h"
+
+#include <algorithm>
+#include <cstring>
+#include <string_view>
+
+static bool Contains(std::string_view Line, std::string_view Phrase)
+{
+	return Line.find(Phrase) != std::string_view::npos;
+}
+
+static bool IsPathChar(char Char)
+{
+	return (Char >= 'a' && Char <= 'z') || (Char >= 'A' && Char <= 'Z') || (Char >= '0' && Char <= '9') || Char == '_' || Char == '/' ||
+	       Char == '\\' || Char == '.' || Char == '-';
+}
+
+// Finds a script reference like "scripts/zm/zm_foo.gsc(123)" or "scripts/zm/zm_foo.gsc:123", the way the script compiler
+// points at the line it stopped at. LowerLine is Line in lower case.
+static bool FindScriptLine(std::string_view Line, std::string_view LowerLine, QString& ScriptFile, int& ScriptLine)
+{
+	for (auto dotIdx = LowerLine.find('.'); dotIdx != std::string_view::npos; dotIdx = LowerLine.find('.', dotIdx + 1))
+	{
+		const auto extension = LowerLine.substr(dotIdx, 4);
+		if (extension != ".gsc" && extension != ".csc" && extension != ".gsh")
+			continue;
+
+		auto lineIdx = dotIdx + 4;
+		while (lineIdx < Line.size() && Line[lineIdx] == ' ')
+			lineIdx++;
+		if (lineIdx == Line.size() || (Line[lineIdx] != '(' && Line[lineIdx] != ':' && Line[lineIdx] != ','))
+			continue;
+		lineIdx++;
+
+		auto line = 0;
+		const auto digitsIdx = lineIdx;
+		while (lineIdx < Line.size() && Line[lineIdx] >= '0' && Line[lineIdx] <= '9' && lineIdx - digitsIdx < 9)
+			line = line * 10 + (Line[lineIdx++] - '0');
+		if (lineIdx == digitsIdx)
+			continue;
+
+		auto fileIdx = dotIdx;
+		while (fileIdx > 0 && IsPathChar(Line[fileIdx - 1]))
+			fileIdx--;
+
+		ScriptFile = QString::fromUtf8(Line.data() + fileIdx, static_cast<int>(dotIdx + 4 - fileIdx));
+		ScriptLine = line;
+		return true;
+	}
+
+	return false;
+}
+
+mlLogParser::mlLogParser()
+{
+	Reset();
+}
+
+void mlLogParser::Reset()
+{
+	mPartialLine.clear();
+	mLineOffset = 0;
+	mLineNumber = 0;
+
+	const QMutexLocker lock(&mMutex);
+	mEntries.clear();
+	mErrorEntries.clear();
+	for (auto& count : mCounts)
+		count = 0;
+	mLineCount = 0;
+}
+
+void mlLogParser::Parse(const char* Data, qint64 Size)
+{
+	auto entries = QVector<mlLogEntry>{};
+	const auto* end = Data + Size;
+	const auto* it = Data;
+
+	if (!mPartialLine.isEmpty())
+	{
+		const auto* newline = static_cast<const char*>(memchr(it, '\n', end - it));
+		mPartialLine.append(it, static_cast<int>((newline != nullptr ? newline : end) - it));
+		if (newline == nullptr)
+			return;
+
+		ParseLine(mPartialLine.constData(), mPartialLine.constData() + mPartialLine.size(), entries);
+		mPartialLine.clear();
+		it = newline + 1;
+	}
+
+	while (it < end)
+	{
+		const auto* newline = static_cast<const char*>(memchr(it, '\n', end - it));
+		if (newline == nullptr)
+		{
+			mPartialLine.append(it, static_cast<int>(end - it));
+			break;
+		}
+
+		ParseLine(it, newline, entries);
+		it = newline + 1;
+	}
+
+	const QMutexLocker lock(&mMutex);
+	for (const auto& entry : entries)
+	{
+		if (entry.Kind != ML_LOG_WARNING)
+			mErrorEntries.append(mEntries.count());
+
+		mCounts[entry.Kind]++;
+		mEntries.append(entry);
+	}
+	mLineCount = mLineNumber;
+}
+
+void mlLogParser::ParseLine(const char* Begin, const char* End, QVector<mlLogEntry>& Entries)
+{
+	const auto length = End - Begin;
+
+	if (End > Begin && End[-1] == '\r')
+		End--;
+
+	auto entry = mlLogEntry{};
+	if (Classify(Begin, End, entry))
+	{
+		entry.Offset = mLineOffset;
+		entry.Line = mLineNumber;
+		Entries.append(entry);
+	}
+
+	mLineOffset += length + 1;
+	mLineNumber++;
+}
+
+bool mlLogParser::Classify(const char* Begin, const char* End, mlLogEntry& Entry)
+{
+	// Lower cased once so each phrase is a single search, which is mostly memchr for its first character. Or-ing in
+	// 0x20 also changes a few control characters and symbols, none of which end up looking like part of a phrase.
+	char lowerBuffer[512];
+	auto lowerLong = QByteArray{};
+	auto* lower = lowerBuffer;
+
+	const auto length = static_cast<size_t>(End - Begin);
+	if (length > sizeof(lowerBuffer))
+	{
+		lowerLong.resize(static_cast<int>(length));
+		lower = lowerLong.data();
+	}
+
+	for (size_t charIdx = 0; charIdx < length; charIdx++)
+		lower[charIdx] = Begin[charIdx] | 0x20;
+
+	const auto line = std::string_view(Begin, length);
+	const auto lowerLine = std::string_view(lower, length);
+
+	const auto error = Contains(line, "ERROR") || Contains(lowerLine, "error:");
+
+	if (FindScriptLine(line, lowerLine, Entry.ScriptFile, Entry.ScriptLine) && (error || Contains(lowerLine, "error")))
+	{
+		Entry.Kind = ML_LOG_SCRIPT_ERROR;
+		return true;
+	}
+
+	Entry.ScriptFile.clear();
+	Entry.ScriptLine = 0;
+
+	// Most lines have neither verb, so those are looked for before the phrases
+	const auto find = Contains(lowerLine, "find");
+	const auto load = Contains(lowerLine, "load");
+
+	if ((find && (Contains(lowerLine, "could not find") || Contains(lowerLine, "couldn't find") || Contains(lowerLine, "cannot find") ||
+	              Contains(lowerLine, "can't find") || Contains(lowerLine, "unable to find"))) ||
+	    (load && (Contains(lowerLine, "could not load") || Contains(lowerLine, "couldn't load"))) || Contains(lowerLine, "missing asset"))
+	{
+		Entry.Kind = ML_LOG_MISSING_ASSET;
+		return true;
+	}
+
+	if (error)
+	{
+		Entry.Kind = ML_LOG_ERROR;
+		return true;
+	}
+
+	if (Contains(line, "WARNING") || Contains(lowerLine, "warning:"))
+	{
+		Entry.Kind = ML_LOG_WARNING;
+		return true;
+	}
+
+	return false;
+}
+
+QString mlLogParser::KindName(mlLogLineKind Kind)
+{
+	switch (Kind)
+	{
+	case ML_LOG_ERROR:
+		return "error";
+	case ML_LOG_WARNING:
+		return "warning";
+	case ML_LOG_MISSING_ASSET:
+		return "missing asset";
+	case ML_LOG_SCRIPT_ERROR:
+		return "script error";
+	default:
+		return QString();
+	}
+}
+
+qint64 mlLogParser::LineCount() const
+{
+	const QMutexLocker lock(&mMutex);
+	return mLineCount;
+}
+
+int mlLogParser::Count(mlLogLineKind Kind) const
+{
+	const QMutexLocker lock(&mMutex);
+	return mCounts[Kind];
+}
+
+int mlLogParser::EntryCount() const
+{
+	const QMutexLocker lock(&mMutex);
+	return mEntries.count();
+}
+
+mlLogEntry mlLogParser::Entry(int EntryIdx) const
+{
+	const QMutexLocker lock(&mMutex);
+	return mEntries.value(EntryIdx);
+}
+
+int mlLogParser::NextError(qint64 Line) const
+{
+	const QMutexLocker lock(&mMutex);
+	const auto it = std::upper_bound(mErrorEntries.begin(), mErrorEntries.end(), Line, [this](qint64 Target, int EntryIdx)
+	{
+		return Target < mEntries[EntryIdx].Line;
+	});
+
+	return it != mErrorEntries.end() ? *it : -1;
+}
+
+int mlLogParser::PreviousError(qint64 Line) const
+{
+	const QMutexLocker lock(&mMutex);
+	const auto it = std::lower_bound(mErrorEntries.begin(), mErrorEntries.end(), Line, [this](int EntryIdx, qint64 Target)
+	{
+		return mEntries[EntryIdx].Line < Target;
+	});
+
+	return it != mErrorEntries.begin() ? *(it - 1) : -1;
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+enum mlLogLineKind
+{
+	ML_LOG_ERROR,
+	ML_LOG_WARNING,
+	ML_LOG_MISSING_ASSET,
+	ML_LOG_SCRIPT_ERROR,
+	ML_LOG_KIND_COUNT
+};
+
+struct mlLogEntry
+{
+	qint64 Offset; // Of the start of the line in the log, in bytes
+	qint64 Line;   // 0 based
+	mlLogLineKind Kind;
+	QString ScriptFile; // Only set for script errors
+	int ScriptLine;
+};
+
+// Classifies the lines of a log as they're written and keeps an index of the ones worth finding again. The log is fed
+// in any pieces, lines that are split between them are put back together. Only one thread should parse, any thread can
+// read the counts and entries while it does.
+class mlLogParser
+{
+public:
+	mlLogParser();
+
+	void Parse(const char* Data, qint64 Size);
+	void Reset();
+
+	qint64 LineCount() const;
+	int Count(mlLogLineKind Kind) const;
+	int EntryCount() const;
+	mlLogEntry Entry(int EntryIdx) const;
+
+	// Errors of any kind, warnings aren't included. Both return an entry index, or -1 if there is none.
+	int NextError(qint64 Line) const;
+	int PreviousError(qint64 Line) const;
+
+	// Returns false for lines that aren't interesting, the offset and line number are left to the caller
+	static bool Classify(const char* Begin, const char* End, mlLogEntry& Entry);
+
+	static QString KindName(mlLogLineKind Kind);
+
+protected:
+	void ParseLine(const char* Begin, const char* End, QVector<mlLogEntry>& Entries);
+
+	// Only touched by the parsing thread
+	QByteArray mPartialLine;
+	qint64 mLineOffset;
+	qint64 mLineNumber;
+
+	mutable QMutex mMutex;
+	QVector<mlLogEntry> mEntries;
+	QVector<int> mErrorEntries;
+	int mCounts[ML_LOG_KIND_COUNT];
+	qint64 mLineCount;
+};
@@ -0,0 +1,428 @@
+#include "stdafx.h"
+
+#include <algorithm>
+#include <cstring>
+
+static char ToLower(char Char)
+{
+	return Char >= 'A' && Char <= 'Z' ? static_cast<char>(Char + ('a' - 'A')) : Char;
+}
+
+mlLogModel::mlLogModel(QObject* Parent)
+	: QAbstractListModel(Parent), mData(nullptr), mMappedSize(0), mIndexedSize(0), mLineCount(0), mCachedRow(-1), mCachedOffset(0)
+{
+	mCheckpoints.append(0);
+}
+
+mlLogModel::~mlLogModel()
+{
+	Unmap();
+}
+
+void mlLogModel::SetFilePath(const QString& FilePath)
+{
+	beginResetModel();
+
+	Unmap();
+	mFile.close();
+	mFile.setFileName(FilePath);
+	mIndexedSize = 0;
+	mLineCount = 0;
+	mCheckpoints.clear();
+	mCheckpoints.append(0);
+	mCachedRow = -1;
+
+	endResetModel();
+
+	Refresh();
+}
+
+QString mlLogModel::FilePath() const
+{
+	return mFile.fileName();
+}
+
+void mlLogModel::Unmap()
+{
+	if (mData != nullptr)
+		mFile.unmap(reinterpret_cast<uchar*>(const_cast<char*>(mData)));
+
+	mData = nullptr;
+	mMappedSize = 0;
+}
+
+void mlLogModel::Refresh()
+{
+	if (!mFile.isOpen() && (mFile.fileName().isEmpty() || !mFile.open(QIODevice::ReadOnly)))
+		return;
+
+	const auto size = mFile.size();
+	if (size <= mMappedSize)
+		return;
+
+	// A mapping can't grow, so the file is mapped again whenever it did. That only costs address space, nothing is read.
+	const auto* data = reinterpret_cast<const char*>(mFile.map(0, size));
+	if (data == nullptr)
+		return;
+
+	Unmap();
+	mData = data;
+	mMappedSize = size;
+
+	auto lineCount = mLineCount;
+	auto indexedSize = mIndexedSize;
+	for (;;)
+	{
+		const auto* newline = static_cast<const char*>(memchr(mData + indexedSize, '\n', mMappedSize - indexedSize));
+		if (newline == nullptr)
+			break;
+
+		indexedSize = newline + 1 - mData;
+		lineCount++;
+
+		if (lineCount % ML_LINES_PER_CHECKPOINT == 0)
+			mCheckpoints.append(indexedSize);
+	}
+
+	if (lineCount == mLineCount)
+		return;
+
+	beginInsertRows(QModelIndex(), mLineCount, lineCount - 1);
+	mLineCount = lineCount;
+	mIndexedSize = indexedSize;
+	endInsertRows();
+}
+
+int mlLogModel::rowCount(const QModelIndex& Parent) const
+{
+	return Parent.isValid() ? 0 : mLineCount;
+}
+
+QVariant mlLogModel::data(const QModelIndex& Index, int Role) const
+{
+	if (!Index.isValid() || Index.row() >= mLineCount)
+		return QVariant();
+
+	if (Role == Qt::DisplayRole)
+		return QString::fromUtf8(Line(Index.row()));
+
+	if (Role == Qt::ForegroundRole)
+	{
+		const auto line = Line(Index.row());
+
+		auto entry = mlLogEntry{};
+		if (!mlLogParser::Classify(line.constData(), line.constData() + line.size(), entry))
+			return QVariant();
+
+		return entry.Kind == ML_LOG_WARNING ? QColor(220, 150, 0) : QColor(230, 60, 60);
+	}
+
+	return QVariant();
+}
+
+QByteArray mlLogModel::Line(int Row) const
+{
+	if (Row < 0 || Row >= mLineCount)
+		return QByteArray();
+
+	const auto begin = LineOffset(Row);
+	const auto* newline = static_cast<const char*>(memchr(mData + begin, '\n', mIndexedSize - begin));
+	auto end = newline - mData;
+	if (end > begin && mData[end - 1] == '\r')
+		end--;
+
+	// The mapping is replaced when the file grows, so the line can't just point into it
+	return QByteArray(mData + begin, static_cast<int>(end - begin));
+}
+
+qint64 mlLogModel::LineOffset(int Row) const
+{
+	if (Row >= mLineCount)
+		return mIndexedSize;
+
+	auto row = Row / ML_LINES_PER_CHECKPOINT * ML_LINES_PER_CHECKPOINT;
+	auto offset = mCheckpoints[Row / ML_LINES_PER_CHECKPOINT];
+	if (mCachedRow >= row && mCachedRow <= Row)
+	{
+		row = mCachedRow;
+		offset = mCachedOffset;
+	}
+
+	for (; row < Row; row++)
+		offset = static_cast<const char*>(memchr(mData + offset, '\n', mIndexedSize - offset)) + 1 - mData;
+
+	mCachedRow = Row;
+	mCachedOffset = offset;
+	return offset;
+}
+
+int mlLogModel::RowAt(qint64 Offset) const
+{
+	const auto checkpoint = std::upper_bound(mCheckpoints.begin(), mCheckpoints.end(), Offset) - mCheckpoints.begin() - 1;
+
+	auto row = static_cast<int>(checkpoint * ML_LINES_PER_CHECKPOINT);
+	auto offset = mCheckpoints[static_cast<int>(checkpoint)];
+	for (;;)
+	{
+		const auto* newline = static_cast<const char*>(memchr(mData + offset, '\n', mIndexedSize - offset));
+		if (newline == nullptr || newline - mData >= Offset)
+			return row;
+
+		offset = newline + 1 - mData;
+		row++;
+	}
+}
+
+int mlLogModel::Find(const QString& Text, int StartRow, bool Forward, Qt::CaseSensitivity CaseSensitivity) const
+{
+	auto needle = Text.toUtf8();
+	if (needle.isEmpty() || mLineCount == 0)
+		return -1;
+
+	StartRow = qBound(0, StartRow, mLineCount - 1);
+
+	auto equal = [CaseSensitivity](char Left, char Right)
+	{
+		return CaseSensitivity == Qt::CaseSensitive ? Left == Right : ToLower(Left) == ToLower(Right);
+	};
+
+	// The text can't span lines, so searching the whole mapped range at once is the same as going line by line
+	if (Forward)
+	{
+		const auto* begin = mData + LineOffset(StartRow);
+		const auto* end = mData + mIndexedSize;
+		const auto* match = std::search(begin, end, needle.constData(), needle.constData() + needle.size(), equal);
+		return match != end ? RowAt(match - mData) : -1;
+	}
+
+	const auto* begin = mData;
+	const auto* end = mData + LineOffset(StartRow + 1);
+	const auto* match = std::find_end(begin, end, needle.constData(), needle.constData() + needle.size(), equal);
+	return match != end ? RowAt(match - mData) : -1;
+}
+
+mlLogView::mlLogView(QWidget* Parent)
+	: QAbstractScrollArea(Parent), mCurrentRow(-1), mAnchorRow(-1), mContentWidth(0), mFollowTail(true)
+{
+	mModel = new mlLogModel(this);
+	connect(mModel, SIGNAL(rowsAboutToBeInserted(QModelIndex, int, int)), this, SLOT(OnRowsAboutToBeInserted()));
+	connect(mModel, SIGNAL(rowsInserted(QModelIndex, int, int)), this, SLOT(OnRowsInserted()));
+	connect(mModel, SIGNAL(modelReset()), this, SLOT(OnModelReset()));
+
+	setFocusPolicy(Qt::StrongFocus);
+	viewport()->setBackgroundRole(QPalette::Base);
+	viewport()->setAutoFillBackground(true);
+	verticalScrollBar()->setSingleStep(1);
+}
+
+void mlLogView::ShowRow(int Row)
+{
+	if (Row < 0 || Row >= mModel->rowCount())
+		return;
+
+	SetCurrentRow(Row, false);
+	verticalScrollBar()->setValue(Row - VisibleRows() / 2);
+}
+
+void mlLogView::Copy() const
+{
+	if (mCurrentRow < 0)
+		return;
+
+	auto lines = QStringList{};
+	for (auto row = qMin(mAnchorRow, mCurrentRow); row <= qMax(mAnchorRow, mCurrentRow); row++)
+		lines.append(QString::fromUtf8(mModel->Line(row)));
+
+	QApplication::clipboard()->setText(lines.join('\n'));
+}
+
+void mlLogView::OnRowsAboutToBeInserted()
+{
+	mFollowTail = verticalScrollBar()->value() >= verticalScrollBar()->maximum();
+}
+
+void mlLogView::OnRowsInserted()
+{
+	UpdateScrollBars();
+
+	if (mFollowTail)
+		verticalScrollBar()->setValue(verticalScrollBar()->maximum());
+
+	viewport()->update();
+}
+
+void mlLogView::OnModelReset()
+{
+	mCurrentRow = -1;
+	mAnchorRow = -1;
+	mContentWidth = 0;
+	mFollowTail = true;
+
+	UpdateScrollBars();
+	verticalScrollBar()->setValue(0);
+	horizontalScrollBar()->setValue(0);
+	viewport()->update();
+}
+
+int mlLogView::LineHeight() const
+{
+	return qMax(fontMetrics().lineSpacing(), 1);
+}
+
+int mlLogView::VisibleRows() const
+{
+	return qMax(viewport()->height() / LineHeight(), 1);
+}
+
+int mlLogView::RowAt(int Y) const
+{
+	return qBound(0, verticalScrollBar()->value() + Y / LineHeight(), qMax(mModel->rowCount() - 1, 0));
+}
+
+void mlLogView::UpdateScrollBars()
+{
+	const auto visibleRows = VisibleRows();
+	verticalScrollBar()->setPageStep(visibleRows);
+	verticalScrollBar()->setRange(0, qMax(mModel->rowCount() - visibleRows, 0));
+
+	horizontalScrollBar()->setPageStep(viewport()->width());
+	horizontalScrollBar()->setRange(0, qMax(mContentWidth - viewport()->width(), 0));
+}
+
+void mlLogView::SetCurrentRow(int Row, bool ExtendSelection)
+{
+	const auto rowCount = mModel->rowCount();
+	if (rowCount == 0)
+		return;
+
+	mCurrentRow = qBound(0, Row, rowCount - 1);
+	if (!ExtendSelection || mAnchorRow < 0)
+		mAnchorRow = mCurrentRow;
+
+	// Keep the current row on screen
+	const auto firstRow = verticalScrollBar()->value();
+	if (mCurrentRow < firstRow)
+		verticalScrollBar()->setValue(mCurrentRow);
+	else if (mCurrentRow >= firstRow + VisibleRows())
+		verticalScrollBar()->setValue(mCurrentRow - VisibleRows() + 1);
+
+	viewport()->update();
+}
+
+void mlLogView::paintEvent(QPaintEvent* Event)
+{
+	QPainter painter(viewport());
+	painter.setFont(font());
+
+	const auto lineHeight = LineHeight();
+	const auto ascent = fontMetrics().ascent();
+	const auto firstRow = verticalScrollBar()->value();
+	const auto lastRow = qMin(firstRow + viewport()->height() / lineHeight + 1, mModel->rowCount());
+	const auto selectionBegin = qMin(mAnchorRow, mCurrentRow);
+	const auto selectionEnd = qMax(mAnchorRow, mCurrentRow);
+	const auto x = 4 - horizontalScrollBar()->value();
+
+	auto contentWidth = mContentWidth;
+
+	for (auto row = firstRow; row < lastRow; row++)
+	{
+		const auto y = (row - firstRow) * lineHeight;
+		const auto index = mModel->index(row);
+		const auto text = mModel->data(index, Qt::DisplayRole).toString();
+
+		auto color = mModel->data(index, Qt::ForegroundRole).value<QColor>();
+		if (!color.isValid())
+			color = palette().color(QPalette::Text);
+
+		if (mCurrentRow >= 0 && row >= selectionBegin && row <= selectionEnd)
+		{
+			painter.fillRect(0, y, viewport()->width(), lineHeight, palette().brush(QPalette::Highlight));
+			color = palette().color(QPalette::HighlightedText);
+		}
+
+		painter.setPen(color);
+		painter.drawText(x, y + ascent, text);
+
+		contentWidth = qMax(contentWidth, fontMetrics().horizontalAdvance(text) + 8);
+	}
+
+	// Only lines that were on screen count towards the width, measuring all of them would mean reading the whole log
+	if (contentWidth != mContentWidth)
+	{
+		mContentWidth = contentWidth;
+		QTimer::singleShot(0, this, &mlLogView::UpdateScrollBars);
+	}
+}
+
+void mlLogView::resizeEvent(QResizeEvent* Event)
+{
+	QAbstractScrollArea::resizeEvent(Event);
+
+	const auto followTail = verticalScrollBar()->value() >= verticalScrollBar()->maximum();
+	UpdateScrollBars();
+	if (followTail)
+		verticalScrollBar()->setValue(verticalScrollBar()->maximum());
+}
+
+void mlLogView::mousePressEvent(QMouseEvent* Event)
+{
+	if (Event->button() != Qt::LeftButton)
+		return QAbstractScrollArea::mousePressEvent(Event);
+
+	SetCurrentRow(RowAt(Event->pos().y()), (Event->modifiers() & Qt::ShiftModifier) != 0);
+}
+
+void mlLogView::mouseMoveEvent(QMouseEvent* Event)
+{
+	if (!(Event->buttons() & Qt::LeftButton))
+		return QAbstractScrollArea::mouseMoveEvent(Event);
+
+	SetCurrentRow(RowAt(Event->pos().y()), true);
+}
+
+void mlLogView::keyPressEvent(QKeyEvent* Event)
+{
+	if (Event->matches(QKeySequence::Copy))
+		return Copy();
+
+	if (Event->matches(QKeySequence::SelectAll))
+	{
+		mAnchorRow = 0;
+		mCurrentRow = mModel->rowCount() - 1;
+		viewport()->update();
+		return;
+	}
+
+	const auto extendSelection = (Event->modifiers() & Qt::ShiftModifier) != 0;
+	const auto currentRow = mCurrentRow >= 0 ? mCurrentRow : verticalScrollBar()->value();
+
+	switch (Event->key())
+	{
+	case Qt::Key_Up:
+		SetCurrentRow(currentRow - 1, extendSelection);
+		break;
+	case Qt::Key_Down:
+		SetCurrentRow(currentRow + 1, extendSelection);
+		break;
+	case Qt::Key_PageUp:
+		SetCurrentRow(currentRow - VisibleRows(), extendSelection);
+		break;
+	case Qt::Key_PageDown:
+		SetCurrentRow(currentRow + VisibleRows(), extendSelection);
+		break;
+	case Qt::Key_Home:
+		SetCurrentRow(0, extendSelection);
+		break;
+	case Qt::Key_End:
+		SetCurrentRow(mModel->rowCount() - 1, extendSelection);
+		break;
+	default:
+		QAbstractScrollArea::keyPressEvent(Event);
+		break;
+	}
+}
+
+void mlLogView::scrollContentsBy(int DeltaX, int DeltaY)
+{
+	viewport()->update();
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+// A log file as a list of lines, read straight from a memory mapping of the file. Only the offset of every 64th line is
+// kept, a row is found from the nearest one of those, so the index stays small however long the log gets. The file can
+// still be growing, Refresh() picks up whatever was written since the last call. Lines only show up once they're
+// complete.
+class mlLogModel : public QAbstractListModel
+{
+	Q_OBJECT
+
+public:
+	explicit mlLogModel(QObject* Parent = nullptr);
+	~mlLogModel() override;
+
+	// The file doesn't need to exist yet
+	void SetFilePath(const QString& FilePath);
+	QString FilePath() const;
+
+	int rowCount(const QModelIndex& Parent = QModelIndex()) const override;
+	QVariant data(const QModelIndex& Index, int Role = Qt::DisplayRole) const override;
+
+	// The line as it is in the file, without its line break
+	QByteArray Line(int Row) const;
+
+	// The first row at or after StartRow with Text in it, or the last one at or before it, -1 if there is none. Only
+	// ASCII letters are matched case insensitively.
+	int Find(const QString& Text, int StartRow, bool Forward, Qt::CaseSensitivity CaseSensitivity) const;
+
+public slots:
+	void Refresh();
+
+protected:
+	enum
+	{
+		ML_LINES_PER_CHECKPOINT = 64
+	};
+
+	void Unmap();
+	qint64 LineOffset(int Row) const;
+	int RowAt(qint64 Offset) const;
+
+	QFile mFile;
+	const char* mData;
+	qint64 mMappedSize;
+	qint64 mIndexedSize; // Up to the end of the last complete line
+	int mLineCount;
+	QVector<qint64> mCheckpoints; // Offset of every ML_LINES_PER_CHECKPOINT'th line
+
+	// The last row looked up, so going through the rows one after the other doesn't start from a checkpoint every time
+	mutable int mCachedRow;
+	mutable qint64 mCachedOffset;
+};
+
+// Shows an mlLogModel. Only the rows that are on screen are ever asked for, unlike QListView, which lays out every row of
+// its model again whenever rows are added. Follows the end of the log while it's scrolled to the bottom.
+class mlLogView : public QAbstractScrollArea
+{
+	Q_OBJECT
+
+public:
+	explicit mlLogView(QWidget* Parent = nullptr);
+
+	mlLogModel* Model() const
+	{
+		return mModel;
+	}
+
+	// -1 if no row is selected
+	int CurrentRow() const
+	{
+		return mCurrentRow;
+	}
+
+	// Selects the row and scrolls it to the middle of the view
+	void ShowRow(int Row);
+
+	// Copies the selected rows to the clipboard
+	void Copy() const;
+
+protected slots:
+	void OnRowsAboutToBeInserted();
+	void OnRowsInserted();
+	void OnModelReset();
+
+protected:
+	void paintEvent(QPaintEvent* Event) override;
+	void resizeEvent(QResizeEvent* Event) override;
+	void mousePressEvent(QMouseEvent* Event) override;
+	void mouseMoveEvent(QMouseEvent* Event) override;
+	void keyPressEvent(QKeyEvent* Event) override;
+	void scrollContentsBy(int DeltaX, int DeltaY) override;
+
+	int LineHeight() const;
+	int VisibleRows() const;
+	int RowAt(int Y) const;
+	void UpdateScrollBars();
+	void SetCurrentRow(int Row, bool ExtendSelection);
+
+	mlLogModel* mModel;
+	int mCurrentRow;
+	int mAnchorRow; // The other end of the selection
+	int mContentWidth;
+	bool mFollowTail;
+};
@@ -31,10 +31,6 @@
 
 static const int appId = 311210;
 
-const char* gLanguages[] = {
-	"english", "french", "italian", "spanish", "german", "portuguese", "russian", "polish", "japanese",
-	"traditionalchinese", "simplifiedchinese", "englisharabic"
-};
 const char* gTags[] = {
 	"Animation", "Audio", "Character", "Map", "Mod", "Mode", "Model", "Multiplayer", "Scorestreak", "Skin",
 	"Specialist", "Texture", "UI", "Vehicle", "Visual Effect", "Weapon", "WIP", "Zombies"
@@ -58,198 +54,1006 @@ enum mlItemType
 	ML_ITEM_MOD
 };
 
-mlBuildThread::mlBuildThread(QList<QPair<QString, QStringList>> Commands, bool IgnoreErrors)
-	: mCommands(std::move(Commands)), mSuccess(false), mCancel(false), mIgnoreErrors(IgnoreErrors)
+mlBuildThread::mlBuildThread(mlBuildGraph Graph, int MaxJobs, const mlResourceLimits& Limits, bool IgnoreErrors, bool ForceRebuild)
+	: mGraph(std::move(Graph)), mMaxJobs(qMax(MaxJobs, 1)), mLimits(Limits), mCancelTime(0), mStepsDone(0), mIgnoreErrors(IgnoreErrors),
+	  mForceRebuild(ForceRebuild)
+{
+}
+
+QString mlBuildThread::Progress()
 {
+	return QString("%1/%2 steps").arg(mStepsDone.load()).arg(mGraph.Count());
 }
 
 void mlBuildThread::run()
 {
+	enum mlStepState
+	{
+		ML_STEP_PENDING,
+		ML_STEP_RUNNING,
+		ML_STEP_SUCCEEDED,
+		ML_STEP_FAILED,
+		ML_STEP_SKIPPED
+	};
+
+	const auto stepCount = mGraph.Count();
+	auto states = QVector<mlStepState>(stepCount, ML_STEP_PENDING);
+	auto processes = QVector<mlProcess*>(stepCount, nullptr);
+	auto pendingOutput = QVector<QByteArray>(stepCount);
+	auto startTimes = QVector<qint64>(stepCount, 0);
+	auto childTimers = QVector<QElapsedTimer>(stepCount);
+	auto fingerprints = QVector<QJsonObject>(stepCount);
+	auto previousFingerprints = QVector<QJsonObject>(stepCount);
+	auto cacheThreads = QVector<QThread*>(stepCount, nullptr);
+	mlBuildCacheMemo cacheMemo;
+	auto startDates = QVector<QDateTime>(stepCount);
+	auto outputSizes = QVector<qint64>(stepCount, 0);
+	auto cacheChecked = QVector<bool>(stepCount, false);
+	auto costs = QVector<mlToolCost>(stepCount, mlToolCost{0, 0});
+	auto waitReported = QVector<bool>(stepCount, false);
+
+	auto governor = mlGovernor{mLimits};
+	const auto megabyte = 1024 * 1024;
+
+	auto running = 0;
+	auto checking = 0;
+	auto launching = -1;
+	auto stopping = false;
 	auto success = true;
+	auto totalOverhead = qint64{0};
+
+	// Output is forwarded in whole lines, the sink ends every text it gets with a line break. With more than one job
+	// in flight each line is tagged with the step name.
+	const auto tagOutput = mMaxJobs > 1 && stepCount > 1;
+
+	// Launcher-side overhead is everything a step costs that isn't spent inside the child process
+	// (spawning, piping, waiting on us to notice it exited)
+	auto buildTimer = QElapsedTimer{};
+	buildTimer.start();
 
-	for (const auto& command : mCommands)
+	QEventLoop eventLoop;
+	std::function<void()> schedule;
+
+	auto forwardOutput = [&](int StepIdx, const QByteArray& Output, bool Flush)
 	{
-		/*if (Command.first.endsWith("BlackOps3.exe"))
+		outputSizes[StepIdx] += Output.size();
+
+		auto& buffer = pendingOutput[StepIdx];
+		buffer.append(Output);
+
+		const auto end = Flush ? buffer.size() : buffer.lastIndexOf('\n') + 1;
+		if (end <= 0)
+			return;
+
+		auto text = QString{};
+		if (tagOutput)
+		{
+			const auto prefix = QString("[%1] ").arg(mGraph.Step(StepIdx).Name);
+			for (const auto& line : buffer.left(end).split('\n'))
+			{
+				if (!line.isEmpty())
+					text += prefix + QString::fromLocal8Bit(line).remove('\r') + '\n';
+			}
+		}
+		else
 		{
-			auto parameters = Command.second.join(" ");
-			const auto run_str = QString("steam:///rungameid//%1").arg(AppId).toStdWString();
-			const auto* game_str = run_str.c_str();
-			ShellExecute(nullptr, L"open", L"steam://rungameid/311210//+devmap mp_sector", nullptr, nullptr, SW_SHOWDEFAULT);
+			// Untagged output keeps its blank lines
+			text = QString::fromLocal8Bit(buffer.left(end)).remove('\r');
+		}
 
-			continue;
-		}*/
-		
-		auto* process = new QProcess();
-		connect(process, SIGNAL(finished(int)), process, SLOT(deleteLater()));
-		process->setWorkingDirectory(QFileInfo(command.first).absolutePath());
-		process->setProcessChannelMode(QProcess::MergedChannels);
+		buffer.remove(0, end);
 
-		emit OutputReady(command.first + ' ' + command.second.join(' ') + "\n");
+		if (!text.isEmpty())
+			emit OutputReady(text);
+	};
+
+	auto finishStep = [&](int StepIdx, mlStepState State)
+	{
+		auto* process = processes[StepIdx];
+		forwardOutput(StepIdx, process->readAll(), true);
 
-		process->start(command.first, command.second);
-		for (;;)
+		const auto childTime = process->error() == QProcess::FailedToStart ? 0 : childTimers[StepIdx].elapsed();
+		const auto stepTime = buildTimer.elapsed() - startTimes[StepIdx];
+		const auto overhead = stepTime - childTime;
+		totalOverhead += overhead;
+
+		states[StepIdx] = State;
+		running--;
+
+		const auto& step = mGraph.Step(StepIdx);
+		if (mlGovernor::Governs(step))
+			governor.Release(costs[StepIdx]);
+
+		if (State == ML_STEP_SUCCEEDED && !fingerprints[StepIdx].isEmpty())
+		{
+			if (!mlBuildCache::Save(step.CacheManifest, fingerprints[StepIdx]))
+				emit OutputReady(QString("WARNING: Could not write '%1'\n").arg(step.CacheManifest));
+		}
+
+		emit OutputReady(QString("%1 %2 in %3 ms (launcher overhead %4 ms)\n").arg(step.Name,
+			State == ML_STEP_SUCCEEDED ? "finished" : "failed").arg(stepTime).arg(overhead));
+
+		auto record = mlBuildRecord{};
+		record.Tool = QFileInfo(step.Program).completeBaseName();
+		record.Arguments = step.Arguments;
+		record.Target = step.Target;
+		record.Start = startDates[StepIdx];
+		record.Duration = stepTime;
+		record.ExitCode = process->exitStatus() == QProcess::NormalExit && process->error() != QProcess::FailedToStart ? process->exitCode() : -1;
+		record.OutputSize = outputSizes[StepIdx];
+		record.PeakMemory = process->PeakMemory();
+		record.CpuTime = process->CpuTime();
+		mlBuildHistory::Append(record);
+
+		if (State != ML_STEP_SUCCEEDED)
 		{
-			Sleep(100);
+			success = false;
 
-			if (process->waitForReadyRead(0))
-			emit OutputReady(process->readAll());
+			// Abnormal exits (crashes or cancelling) always stop the build, regular errors only if we're not ignoring them
+			if (!mIgnoreErrors || process->exitStatus() != QProcess::NormalExit || process->error() == QProcess::FailedToStart)
+				stopping = true;
+		}
+	};
 
-			const auto state = process->state();
-			if (state == QProcess::NotRunning)
-				break;
+	auto startStep = [&](int StepIdx)
+	{
+		const auto& step = mGraph.Step(StepIdx);
 
-			if (mCancel)
-				process->kill();
+		auto* process = new mlProcess();
+		processes[StepIdx] = process;
+		states[StepIdx] = ML_STEP_RUNNING;
+		startTimes[StepIdx] = buildTimer.elapsed();
+		startDates[StepIdx] = QDateTime::currentDateTime();
+		running++;
+		if (mlGovernor::Governs(step))
+		{
+			governor.Acquire(costs[StepIdx]);
+			process->SetLowPriority(mLimits.LowPriority);
 		}
 
-		if (process->exitStatus() != QProcess::NormalExit)
-			return;
+		process->setWorkingDirectory(QFileInfo(step.Program).absolutePath());
+		process->setProcessChannelMode(QProcess::MergedChannels);
 
-		if (process->exitCode() != 0)
+		connect(process, &QProcess::started, [&childTimers, StepIdx]()
 		{
-			success = false;
-			if (!mIgnoreErrors)
+			childTimers[StepIdx].start();
+		});
+		connect(process, &QProcess::readyRead, [&forwardOutput, process, StepIdx]()
+		{
+			forwardOutput(StepIdx, process->readAll(), false);
+		});
+		connect(process, qOverload<int, QProcess::ExitStatus>(&QProcess::finished), [&, process, StepIdx]()
+		{
+			const auto succeeded = process->exitStatus() == QProcess::NormalExit && process->exitCode() == 0;
+			finishStep(StepIdx, succeeded ? ML_STEP_SUCCEEDED : ML_STEP_FAILED);
+			schedule();
+		});
+		connect(process, &QProcess::errorOccurred, [&, StepIdx](QProcess::ProcessError Error)
+		{
+			// Failing to start can be reported from inside start(), that case is handled below once start() returns
+			if (Error != QProcess::FailedToStart || states[StepIdx] != ML_STEP_RUNNING || launching == StepIdx)
 				return;
+
+			emit OutputReady(QString("ERROR: Could not start '%1'\n").arg(mGraph.Step(StepIdx).Program));
+			finishStep(StepIdx, ML_STEP_FAILED);
+			schedule();
+		});
+
+		emit OutputReady(step.Program + ' ' + step.Arguments.join(' ') + "\n");
+
+		launching = StepIdx;
+		process->start(step.Program, step.Arguments);
+		launching = -1;
+
+		if (process->state() == QProcess::NotRunning && states[StepIdx] == ML_STEP_RUNNING)
+		{
+			emit OutputReady(QString("ERROR: Could not start '%1'\n").arg(step.Program));
+			finishStep(StepIdx, ML_STEP_FAILED);
+		}
+		else if (mCancel)
+		{
+			process->KillTree();
+		}
+	};
+
+	auto finishCacheCheck = [&](int StepIdx)
+	{
+		const auto& step = mGraph.Step(StepIdx);
+		auto& fingerprint = fingerprints[StepIdx];
+		const auto& previous = previousFingerprints[StepIdx];
+
+		cacheChecked[StepIdx] = true;
+		if (mCancel)
+		{
+			fingerprint = QJsonObject{};
+			return;
+		}
+
+		fingerprint["Program"] = step.Program;
+		fingerprint["Arguments"] = QJsonArray::fromStringList(step.Arguments);
+
+		auto outputsExist = true;
+		for (const auto& output : step.CacheOutputs)
+			outputsExist = outputsExist && QFileInfo(output).isFile();
+
+		if (!mForceRebuild && outputsExist && mlBuildCache::Matches(fingerprint, previous))
+		{
+			states[StepIdx] = ML_STEP_SUCCEEDED;
+			fingerprint = QJsonObject{};
+			emit OutputReady(QString("%1 is up to date, skipped (no inputs changed since it last succeeded, check \"Force Rebuild\" to run it anyway)\n").arg(step.Name));
+			return;
 		}
+
+		emit OutputReady(QString("%1 needs to run: %2\n").arg(step.Name,
+			mForceRebuild ? QString("\"Force Rebuild\" is checked") : mlBuildCache::Differences(fingerprint, previous)));
+
+		// The manifest is only valid for complete outputs, so it's removed until the step succeeds again
+		QFile::remove(step.CacheManifest);
+	};
+
+	// Fingerprinting can hash whole folders, so it runs on a thread of its own and the event loop keeps forwarding
+	// output and handling cancels in the meantime
+	auto startCacheCheck = [&](int StepIdx)
+	{
+		const auto& step = mGraph.Step(StepIdx);
+		auto* previous = &previousFingerprints[StepIdx];
+		auto* fingerprint = &fingerprints[StepIdx];
+
+		auto* thread = QThread::create([this, &step, &cacheMemo, previous, fingerprint]()
+		{
+			*previous = mlBuildCache::Load(step.CacheManifest);
+			*fingerprint = mlBuildCache::Fingerprint(step.CacheInputs, step.CacheExcludes, *previous, &mCancel, &cacheMemo);
+		});
+
+		cacheThreads[StepIdx] = thread;
+		checking++;
+
+		// The thread object belongs to this thread, so the result is handled on our event loop
+		connect(thread, &QThread::finished, &eventLoop, [&, StepIdx]()
+		{
+			checking--;
+			finishCacheCheck(StepIdx);
+			schedule();
+		});
+
+		thread->start();
+	};
+
+	schedule = [&]()
+	{
+		// Once a step has to wait for resources nothing after it may take them, or a stream of small steps could keep
+		// a heavy one waiting forever
+		auto admissionClosed = false;
+
+		for (auto stepIdx = 0; stepIdx < stepCount; stepIdx++)
+		{
+			if (states[stepIdx] != ML_STEP_PENDING)
+				continue;
+
+			// Merge steps are still resolved while stopping so a failed part shows up in their consolidated status
+			const auto& step = mGraph.Step(stepIdx);
+			const auto merge = step.Program.isEmpty();
+			if (stopping && !merge)
+				continue;
+
+			auto ready = true;
+			auto blocked = false;
+
+			for (auto dependency : step.Dependencies)
+			{
+				const auto state = states[dependency];
+				if (state == ML_STEP_PENDING || state == ML_STEP_RUNNING)
+					ready = false;
+				else if (state != ML_STEP_SUCCEEDED && !step.RunAfterFailure)
+					blocked = true;
+			}
+
+			// Dependencies always come first, so a single pass propagates skips through the whole downstream subgraph
+			if (blocked)
+			{
+				states[stepIdx] = ML_STEP_SKIPPED;
+				emit OutputReady(QString("%1 skipped (a step it depends on failed)\n").arg(step.Name));
+				continue;
+			}
+
+			if (!ready)
+				continue;
+
+			if (merge)
+			{
+				auto failedParts = QStringList{};
+				auto skippedParts = 0;
+				auto firstStart = buildTimer.elapsed();
+				auto ranParts = 0;
+
+				for (auto dependency : step.Dependencies)
+				{
+					if (states[dependency] == ML_STEP_FAILED)
+						failedParts.append(mGraph.Step(dependency).Name);
+					else if (states[dependency] == ML_STEP_SKIPPED)
+						skippedParts++;
+
+					if (processes[dependency] != nullptr)
+					{
+						firstStart = qMin(firstStart, startTimes[dependency]);
+						ranParts++;
+					}
+				}
+
+				const auto partCount = step.Dependencies.count();
+				if (!failedParts.isEmpty())
+				{
+					states[stepIdx] = ML_STEP_FAILED;
+					success = false;
+					emit OutputReady(QString("%1 failed, %2 of %3 parts failed (%4)\n").arg(step.Name).arg(failedParts.count())
+						.arg(partCount).arg(failedParts.join(", ")));
+				}
+				else if (skippedParts > 0)
+				{
+					states[stepIdx] = ML_STEP_SKIPPED;
+					emit OutputReady(QString("%1 skipped (a step it depends on failed)\n").arg(step.Name));
+				}
+				else
+				{
+					states[stepIdx] = ML_STEP_SUCCEEDED;
+					if (ranParts == 0)
+						emit OutputReady(QString("%1 is up to date, all %2 parts were skipped\n").arg(step.Name).arg(partCount));
+					else
+						emit OutputReady(QString("%1 finished, all %2 parts succeeded in %3 ms\n").arg(step.Name).arg(partCount)
+							.arg(buildTimer.elapsed() - firstStart));
+				}
+
+				continue;
+			}
+
+			if (running >= mMaxJobs)
+				continue;
+
+			const auto poolLimit = mGraph.PoolLimit(step.Pool);
+			if (poolLimit > 0)
+			{
+				auto poolRunning = 0;
+				for (auto otherIdx = 0; otherIdx < stepCount; otherIdx++)
+				{
+					if (states[otherIdx] == ML_STEP_RUNNING && mGraph.Step(otherIdx).Pool == step.Pool)
+						poolRunning++;
+				}
+
+				if (poolRunning >= poolLimit)
+					continue;
+			}
+
+			// The step waits until its fingerprint is ready, schedule() runs again once it is
+			if (!step.CacheManifest.isEmpty() && !cacheChecked[stepIdx])
+			{
+				if (cacheThreads[stepIdx] == nullptr)
+					startCacheCheck(stepIdx);
+				continue;
+			}
+
+			// Steps that don't fit wait for a running one to finish and free up its share of the budget
+			costs[stepIdx] = governor.Cost(step);
+			if (mlGovernor::Governs(step) && (admissionClosed || !governor.Admits(costs[stepIdx])))
+			{
+				admissionClosed = true;
+
+				if (!waitReported[stepIdx])
+				{
+					const auto inUse = governor.InUse();
+					emit OutputReady(QString("%1 is waiting for resources, it needs %2 cores and %3 MB while %4 of %5 cores and %6 of %7 MB are in use\n")
+						.arg(step.Name).arg(costs[stepIdx].Cores, 0, 'f', 1).arg(costs[stepIdx].Memory / megabyte)
+						.arg(inUse.Cores, 0, 'f', 1).arg(mLimits.Cores, 0, 'f', 1)
+						.arg(inUse.Memory / megabyte).arg(mLimits.Memory / megabyte));
+					waitReported[stepIdx] = true;
+				}
+
+				continue;
+			}
+
+			startStep(stepIdx);
+		}
+
+		auto stepsDone = 0;
+		for (auto state : states)
+		{
+			if (state != ML_STEP_PENDING && state != ML_STEP_RUNNING)
+				stepsDone++;
+		}
+		mStepsDone = stepsDone;
+
+		if (running == 0 && checking == 0)
+			eventLoop.quit();
+	};
+
+	auto killRunningSteps = [&]()
+	{
+		for (auto stepIdx = 0; stepIdx < stepCount; stepIdx++)
+		{
+			if (states[stepIdx] == ML_STEP_RUNNING)
+				processes[stepIdx]->KillTree();
+		}
+	};
+
+	// Killing a process tree should only take a few milliseconds, if anything survives this long we try again and say so.
+	// Tools that survive every attempt are given up on, the build fails instead of waiting for them forever.
+	const auto cancelWarningTime = 2000;
+	const auto cancelAttempts = 3;
+	auto cancelRetries = 0;
+	auto cancelFailed = false;
+	QTimer cancelWatchdog;
+	cancelWatchdog.setSingleShot(true);
+	cancelWatchdog.setInterval(cancelWarningTime);
+
+	connect(&cancelWatchdog, &QTimer::timeout, [&]()
+	{
+		if (++cancelRetries >= cancelAttempts)
+		{
+			auto survivors = QStringList{};
+			for (auto stepIdx = 0; stepIdx < stepCount; stepIdx++)
+			{
+				if (states[stepIdx] != ML_STEP_RUNNING)
+					continue;
+
+				// Deleting a QProcess waits for the process to exit, the ones that won't are left alone
+				processes[stepIdx]->disconnect();
+				processes[stepIdx] = nullptr;
+				states[stepIdx] = ML_STEP_FAILED;
+				survivors.append(mGraph.Step(stepIdx).Name);
+			}
+
+			emit OutputReady(QString("ERROR: Could not stop %1 within %2 ms of cancelling, giving up on them\n")
+				.arg(survivors.join(", ")).arg(cancelAttempts * cancelWarningTime));
+
+			cancelFailed = true;
+			running = 0;
+			if (checking == 0)
+				eventLoop.quit();
+			return;
+		}
+
+		emit OutputReady(QString("WARNING: Tools are still running %1 ms after cancelling, killing them again\n").arg(cancelWarningTime));
+		killRunningSteps();
+		cancelWatchdog.start();
+	});
+
+	// Cancel() is called from the GUI thread, this is queued to the worker and wakes up the event loop
+	connect(this, &mlBuildThread::CancelRequested, &eventLoop, [&]()
+	{
+		stopping = true;
+		killRunningSteps();
+		cancelWatchdog.start();
+	});
+
+	if (!mCancel)
+		schedule();
+
+	if (running > 0 || checking > 0)
+		eventLoop.exec();
+
+	qDeleteAll(processes);
+
+	// finished() is emitted just before a thread actually ends
+	for (auto* thread : cacheThreads)
+	{
+		if (thread != nullptr)
+			thread->wait();
+	}
+	qDeleteAll(cacheThreads);
+
+	if (mCancel && !cancelFailed)
+	{
+		const auto cancelTime = mCancelTime.load();
+		emit OutputReady(QString("Build cancelled, all tools stopped %1 ms after cancelling\n")
+			.arg(cancelTime != 0 ? QDeadlineTimer::current().deadline() - cancelTime : 0));
+	}
+
+	if (stepCount > 1)
+		emit OutputReady(QString("Build finished in %1 ms, total launcher overhead %2 ms over %3 steps\n")
+			.arg(buildTimer.elapsed()).arg(totalOverhead).arg(stepCount));
+
+	for (auto state : states)
+	{
+		if (state != ML_STEP_SUCCEEDED)
+			success = false;
 	}
 
 	mSuccess = success;
 }
 
-mlConvertThread::mlConvertThread(QStringList& Files, QString& OutputDir, bool IgnoreErrors, bool OverwriteFiles)
-	: mFiles(Files), mOutputDir(OutputDir), mOverwrite(OverwriteFiles), mSuccess(false), mCancel(false),
-	  mIgnoreErrors(IgnoreErrors)
+mlConvertThread::mlConvertThread(QStringList& Files, QString& OutputDir, bool IgnoreErrors, bool OverwriteFiles, int MaxWorkers,
+                                 const QStringList& OutputDirs)
+	: mFiles(Files), mOutputDir(OutputDir), mOutputDirs(OutputDirs), mOverwrite(OverwriteFiles), mMaxWorkers(qMax(MaxWorkers, 1)),
+	  mIgnoreErrors(IgnoreErrors), mUseCache(true), mJournaled(false)
+{
+}
+
+QString mlConvertThread::Progress()
+{
+	const auto stats = mProgress.Stats(0);
+	return QString("%1/%2 files, %3 MB/s").arg(stats.DoneFiles).arg(stats.TotalFiles).arg(stats.BytesPerSecond / (1024.0 * 1024.0), 0, 'f', 1);
+}
+
+QString mlConvertThread::DefaultConverterPath()
 {
+	const auto toolsPath = QDir::fromNativeSeparators(getenv("TA_TOOLS_PATH"));
+	return QString("%1bin/export2bin.exe").arg(toolsPath);
+}
+
+void mlConvertThread::SetConverter(const QString& Program, const QStringList& Arguments)
+{
+	mConverterPath = Program;
+	mConverterArguments = Arguments;
 }
 
 void mlConvertThread::run()
 {
+	enum mlConvertResult
+	{
+		ML_CONVERT_PENDING,
+		ML_CONVERT_SUCCEEDED,
+		ML_CONVERT_SKIPPED,
+		ML_CONVERT_FAILED
+	};
+
+	const auto fileCount = mFiles.count();
+	auto results = QVector<mlConvertResult>(fileCount, ML_CONVERT_PENDING);
+	auto logs = QVector<QString>(fileCount);
+	auto processes = QVector<mlProcess*>(fileCount, nullptr);
+
+	// Latencies run from starting the converter until it exited, -1 for files it never ran on
+	auto sizes = QVector<qint64>(fileCount);
+	auto startTimes = QVector<qint64>(fileCount, -1);
+	auto totalSize = qint64{0};
+	for (auto fileIdx = 0; fileIdx < fileCount; fileIdx++)
+	{
+		sizes[fileIdx] = QFileInfo(mFiles[fileIdx]).size();
+		totalSize += sizes[fileIdx];
+	}
+
+	auto batchTimer = QElapsedTimer{};
+	batchTimer.start();
+	mProgress.Start(fileCount, totalSize);
+
+	const auto executablePath = mConverterPath.isEmpty() ? DefaultConverterPath() : mConverterPath;
+
+	auto cache = mlConvertCache{executablePath};
+
+	mlConvertJournal journal;
+	if (mJournaled)
+	{
+		auto batch = mlConvertBatch{};
+		batch.Files = mFiles;
+		batch.OutputDirs = mOutputDirs;
+		batch.OutputDir = mOutputDir;
+		batch.Overwrite = mOverwrite;
+		journal.Begin(batch);
+	}
+
 	auto success = true;
+	auto stopping = false;
+	auto running = 0; // Files being checked on the pool or converted
+	auto launching = -1;
+	auto nextFile = 0;
+	auto nextLog = 0;
+
+	// Totals of the exports that passed validation, for the summary
+	auto checkedModels = 0;
+	auto checkedAnims = 0;
+	auto checkedSize = qint64{0};
+	auto checkedVerts = qint64{0};
+	auto checkedBones = qint64{0};
+	auto checkedFrames = qint64{0};
+	auto rejected = 0;
+
+	// What the pool found out about a file before it's converted, still pending if the converter has to run on it
+	struct mlPreparedFile
+	{
+		mlConvertResult Result;
+		QString Log;
+		QString Key;
+		QString TargetPath;
+		bool Animation;
+		mlExportInfo ExportInfo;
+	};
 
-	auto convCountSuccess = 0;
-	auto convCountSkipped = 0;
-	auto convCountFailed = 0;
+	QEventLoop eventLoop;
+	std::function<void()> startFiles;
+
+	// Checks files ahead of converting them, its tasks are waited for right after the event loop
+	QThreadPool preparePool;
+	preparePool.setMaxThreadCount(mMaxWorkers);
 
-	for (QString file : mFiles)
+	// Files finish in any order, their logs are held back until every file before them is done so the output reads
+	// exactly like it did when they were converted one at a time
+	auto finishFile = [&](int FileIdx, mlConvertResult Result)
 	{
-		QFileInfo fileInfo(file);
-		const auto workingDirectory = fileInfo.absolutePath();
+		results[FileIdx] = Result;
+		journal.Record(FileIdx, Result != ML_CONVERT_FAILED);
 
-		auto* process = new QProcess();
-		connect(process, SIGNAL(finished(int)), process, SLOT(deleteLater()));
-		process->setWorkingDirectory(workingDirectory);
-		process->setProcessChannelMode(QProcess::MergedChannels);
+		const auto latency = startTimes[FileIdx] >= 0 ? batchTimer.elapsed() - startTimes[FileIdx] : -1;
+		mProgress.FileFinished(sizes[FileIdx], Result == ML_CONVERT_FAILED, latency);
 
-		file = fileInfo.baseName();
+		while (nextLog < fileCount && results[nextLog] != ML_CONVERT_PENDING)
+		{
+			if (!logs[nextLog].isEmpty())
+				emit OutputReady(logs[nextLog]);
 
-		const auto toolsPath = QDir::fromNativeSeparators(getenv("TA_TOOLS_PATH"));
-		const auto executablePath = QString("%1bin/export2bin.exe").arg(toolsPath);
+			logs[nextLog].clear();
+			nextLog++;
+		}
+	};
 
-		auto args = QStringList{};
-		//args.append("/v"); // Verbose
-		args.append("/piped");
+	// Everything that reads whole files before a conversion: hashing the input, the cache and the validator. Runs on
+	// the pool so the event loop keeps servicing the converters' pipes meanwhile, and must only touch the cache.
+	auto prepareFile = [this, &cache](const QString& FilePath, const QString& TargetPath, const QString& OutputDir, bool Animation)
+	{
+		auto prepared = mlPreparedFile{};
+		prepared.Result = ML_CONVERT_PENDING;
+		prepared.TargetPath = TargetPath;
+		prepared.Animation = Animation;
 
-		const auto filepath = fileInfo.absoluteFilePath();
+		if (mCancel)
+			return prepared;
 
-		auto ext = fileInfo.suffix().toUpper();
-		if (ext == "XANIM_EXPORT")
+		// Mirrored subfolders don't exist yet the first time a folder is dropped
+		if (!mOutputDirs.isEmpty())
+			QDir{}.mkpath(OutputDir);
+
+		prepared.Key = mUseCache ? cache.Key(FilePath) : QString();
+		if (!prepared.Key.isEmpty() && cache.IsUpToDate(TargetPath, prepared.Key))
 		{
-			ext = ".XANIM_BIN";
+			prepared.Result = ML_CONVERT_SKIPPED;
+			prepared.Log = "Export2Bin: Skipping file '" + FilePath + "' (unchanged since it was converted)\n";
+			return prepared;
 		}
-		else if (ext == "XMODEL_EXPORT")
+
+		// Outputs we converted from an older version of the file are always replaced, "Overwrite Existing Files" only
+		// decides about files that came from somewhere else
+		if (!mOverwrite && QFileInfo::exists(TargetPath) && !cache.Knows(TargetPath))
 		{
-			ext = ".XMODEL_BIN";
+			prepared.Result = ML_CONVERT_SKIPPED;
+			prepared.Log = "Export2Bin: Skipping file '" + FilePath + "' (file already exists)\n";
+			return prepared;
 		}
-		else
+
+		if (!prepared.Key.isEmpty() && cache.Restore(prepared.Key, TargetPath))
 		{
-			emit OutputReady("Export2Bin: Skipping file '" + filepath + "' (file has invalid extension)\n");
-			convCountSkipped++;
-			continue;
+			prepared.Result = ML_CONVERT_SUCCEEDED;
+			prepared.Log = "Export2Bin: Converting '" + QFileInfo(FilePath).baseName() + "' (reused the result of an earlier conversion)\n";
+			return prepared;
+		}
+
+		// Truncated or malformed exports are turned away here rather than by export2bin, without starting a process
+		prepared.ExportInfo = mlExportValidator::Validate(FilePath);
+		if (!prepared.ExportInfo.IsValid())
+		{
+			prepared.Result = ML_CONVERT_FAILED;
+			prepared.Log = "Export2Bin: Rejected '" + FilePath + "' (" + prepared.ExportInfo.Error + ")\n";
 		}
 
-		auto targetFilepath = QDir::cleanPath(mOutputDir) + QDir::separator() + file + ext;
+		return prepared;
+	};
 
-		QFile infile(filepath);
-		QFile outfile(targetFilepath);
+	// Starts the converter on a file that passed all checks, false if it couldn't be started
+	auto launchFile = [&](int FileIdx, const mlPreparedFile& Prepared)
+	{
+		const auto fileInfo = QFileInfo{mFiles[FileIdx]};
+		const auto file = fileInfo.baseName();
+		const auto filepath = fileInfo.absoluteFilePath();
+		const auto targetFilepath = Prepared.TargetPath;
+		const auto key = Prepared.Key;
+		auto& log = logs[FileIdx];
 
-		if (!mOverwrite && outfile.exists())
+		checkedSize += Prepared.ExportInfo.Size;
+		if (Prepared.Animation)
 		{
-			emit OutputReady("Export2Bin: Skipping file '" + filepath + "' (file already exists)\n");
-			convCountSkipped++;
-			continue;
+			checkedAnims++;
+			checkedFrames += Prepared.ExportInfo.Frames;
 		}
+		else
+		{
+			checkedModels++;
+			checkedVerts += Prepared.ExportInfo.Verts;
+			checkedBones += Prepared.ExportInfo.Bones;
+		}
+
+		// Both files belong to the process, so they're closed along with it. The output goes to a temporary file that
+		// only replaces the target once the conversion succeeded.
+		auto* process = new mlProcess();
+		processes[FileIdx] = process;
+		process->setWorkingDirectory(fileInfo.absolutePath());
 
-		infile.open(QIODevice::OpenMode::enum_type::ReadOnly);
-		if (!infile.isOpen())
+		auto* infile = new QFile(filepath, process);
+		if (!infile->open(QIODevice::ReadOnly))
 		{
-			emit OutputReady("Export2Bin: Could not open '" + filepath + "' for reading\n");
-			convCountFailed++;
-			continue;
+			log = "Export2Bin: Could not open '" + filepath + "' for reading\n";
+
+			if (!mIgnoreErrors)
+			{
+				success = false;
+				stopping = true;
+			}
+
+			finishFile(FileIdx, ML_CONVERT_FAILED);
+			return false;
 		}
 
-		emit OutputReady("Export2Bin: Converting '" + file + "'");
+		auto* outfile = new QSaveFile(targetFilepath, process);
+		if (!outfile->open(QIODevice::WriteOnly))
+		{
+			log = "Export2Bin: Could not open '" + targetFilepath + "' for writing\n";
 
-		auto buf = infile.readAll();
-		infile.close();
+			if (!mIgnoreErrors)
+			{
+				success = false;
+				stopping = true;
+			}
 
-		process->start(executablePath, args);
-		process->write(buf);
-		process->closeWriteChannel();
+			finishFile(FileIdx, ML_CONVERT_FAILED);
+			return false;
+		}
+
+		log = "Export2Bin: Converting '" + file + "'";
+
+		auto args = mConverterArguments;
+		//args.append("/v"); // Verbose
+		args.append("/piped");
 
-		auto standardOutputPipeData = QByteArray{};
-		auto standardErrorPipeData = QByteArray{};
+		// Only a chunk at a time is kept in memory in either direction, no matter how large the file is
+		const auto chunkSize = qint64{256 * 1024};
 
-		for (;;)
+		auto feedInput = [process, infile, chunkSize]()
 		{
-			Sleep(20);
+			if (!infile->isOpen() || process->bytesToWrite() >= chunkSize)
+				return;
+
+			const auto chunk = infile->read(chunkSize);
+			if (!chunk.isEmpty())
+				process->write(chunk);
 
-			if (process->waitForReadyRead(0))
+			if (infile->atEnd())
 			{
-				standardOutputPipeData.append(process->readAllStandardOutput());
-				standardErrorPipeData.append(process->readAllStandardError());
+				infile->close();
+				process->closeWriteChannel();
 			}
+		};
 
-			if (process->state() == QProcess::NotRunning)
-				break;
+		// Errors go to stderr, but the end of stdout is kept too in case the converter complains there
+		auto errorOutput = QSharedPointer<QByteArray>::create();
+		auto outputTail = QSharedPointer<QByteArray>::create();
+		auto writeFailed = QSharedPointer<bool>::create(false);
 
-			if (mCancel)
-				process->kill();
-		}
+		connect(process, &QProcess::bytesWritten, feedInput);
+		connect(process, &QProcess::readyReadStandardOutput, [process, outfile, outputTail, writeFailed]()
+		{
+			const auto data = process->readAllStandardOutput();
+			if (outfile->write(data) != data.size())
+				*writeFailed = true;
+
+			outputTail->append(data.right(4096));
+			outputTail->remove(0, qMax(outputTail->size() - 4096, 0));
+		});
+		connect(process, &QProcess::readyReadStandardError, [process, errorOutput]()
+		{
+			errorOutput->append(process->readAllStandardError());
+		});
+
+		connect(process, qOverload<int, QProcess::ExitStatus>(&QProcess::finished),
+		        [&, process, outfile, errorOutput, outputTail, writeFailed, FileIdx, targetFilepath, key]()
+		{
+			running--;
+
+			const auto data = process->readAllStandardOutput();
+			if (outfile->write(data) != data.size())
+				*writeFailed = true;
+			outputTail->append(data.right(4096));
+			errorOutput->append(process->readAllStandardError());
+
+			if (process->exitStatus() != QProcess::NormalExit)
+			{
+				outfile->cancelWriting();
+				logs[FileIdx] += "\nERROR: Process exited abnormally";
+				success = false;
+				stopping = true;
+				finishFile(FileIdx, ML_CONVERT_FAILED);
+			}
+			else if (process->exitCode() != 0)
+			{
+				outfile->cancelWriting();
+				logs[FileIdx] += '\n' + QString::fromLocal8Bit(outputTail->right(4096) + *errorOutput);
+
+				if (!mIgnoreErrors)
+				{
+					success = false;
+					stopping = true;
+				}
+
+				finishFile(FileIdx, ML_CONVERT_FAILED);
+			}
+			else if (*writeFailed || !outfile->commit())
+			{
+				outfile->cancelWriting();
+				logs[FileIdx] += "\nExport2Bin: Could not write '" + targetFilepath + "'\n";
+
+				if (!mIgnoreErrors)
+				{
+					success = false;
+					stopping = true;
+				}
 
-		if (process->exitStatus() != QProcess::NormalExit)
+				finishFile(FileIdx, ML_CONVERT_FAILED);
+			}
+			else
+			{
+				if (!key.isEmpty())
+					cache.Store(key, targetFilepath);
+
+				finishFile(FileIdx, ML_CONVERT_SUCCEEDED);
+			}
+
+			startFiles();
+		});
+
+		auto failStart = [&, outfile, FileIdx]()
 		{
-			emit OutputReady("ERROR: Process exited abnormally");
+			startTimes[FileIdx] = -1;
+			outfile->cancelWriting();
+			logs[FileIdx] += "\nERROR: Could not start '" + executablePath + "'";
 			success = false;
-			break;
-		}
+			stopping = true;
+			finishFile(FileIdx, ML_CONVERT_FAILED);
+		};
 
-		if (process->exitCode() != 0)
+		connect(process, &QProcess::errorOccurred, [&, failStart, FileIdx](QProcess::ProcessError Error)
 		{
-			emit OutputReady(standardOutputPipeData);
-			emit OutputReady(standardErrorPipeData);
+			// Failing to start can be reported from inside start(), that case is handled below once start() returns
+			if (Error != QProcess::FailedToStart || results[FileIdx] != ML_CONVERT_PENDING || launching == FileIdx)
+				return;
 
-			convCountFailed++;
+			running--;
+			failStart();
+			startFiles();
+		});
+
+		startTimes[FileIdx] = batchTimer.elapsed();
+		launching = FileIdx;
+		process->start(executablePath, args);
+		launching = -1;
+
+		if (process->state() == QProcess::NotRunning && results[FileIdx] == ML_CONVERT_PENDING)
+		{
+			failStart();
+			return false;
+		}
+
+		feedInput();
+		return true;
+	};
+
+	// Back on the event loop once the pool checked the file, a file that still has to be converted keeps counting as
+	// running until its converter exits
+	auto finishPrepare = [&](int FileIdx, const mlPreparedFile& Prepared)
+	{
+		if (Prepared.Result == ML_CONVERT_PENDING && !stopping && launchFile(FileIdx, Prepared))
+			return;
+
+		running--;
+
+		// Only the validator fails a file before it's converted. A file that was still waiting to be converted when
+		// the batch stopped stays pending, so a resumed batch picks it up again.
+		if (Prepared.Result == ML_CONVERT_FAILED)
+		{
+			rejected++;
 
 			if (!mIgnoreErrors)
 			{
 				success = false;
-				break;
+				stopping = true;
 			}
+		}
 
-			continue;
+		if (Prepared.Result != ML_CONVERT_PENDING)
+		{
+			logs[FileIdx] = Prepared.Log;
+			finishFile(FileIdx, Prepared.Result);
 		}
 
-		outfile.open(QIODevice::OpenMode::enum_type::WriteOnly);
-		if (!outfile.isOpen())
+		startFiles();
+	};
+
+	auto startFile = [&](int FileIdx)
+	{
+		const auto fileInfo = QFileInfo{mFiles[FileIdx]};
+		const auto file = fileInfo.baseName();
+		const auto filepath = fileInfo.absoluteFilePath();
+
+		auto ext = fileInfo.suffix().toUpper();
+		if (ext == "XANIM_EXPORT")
+		{
+			ext = ".XANIM_BIN";
+		}
+		else if (ext == "XMODEL_EXPORT")
+		{
+			ext = ".XMODEL_BIN";
+		}
+		else
 		{
-			emit OutputReady("Export2Bin: Could not open '" + targetFilepath + "' for writing\n");
-			continue;
+			logs[FileIdx] = "Export2Bin: Skipping file '" + filepath + "' (file has invalid extension)\n";
+			finishFile(FileIdx, ML_CONVERT_SKIPPED);
+			return;
 		}
 
-		outfile.write(standardOutputPipeData);
-		outfile.close();
+		const auto outputDir = mOutputDirs.isEmpty() ? mOutputDir : mOutputDirs[FileIdx];
+		const auto targetFilepath = QDir::cleanPath(outputDir) + QDir::separator() + file + ext;
+		const auto animation = ext == ".XANIM_BIN";
 
-		convCountSuccess++;
+		running++;
+		preparePool.start([&eventLoop, &prepareFile, &finishPrepare, FileIdx, filepath, targetFilepath, outputDir, animation]()
+		{
+			const auto prepared = prepareFile(filepath, targetFilepath, outputDir, animation);
+			QMetaObject::invokeMethod(&eventLoop, [&finishPrepare, FileIdx, prepared]()
+			{
+				finishPrepare(FileIdx, prepared);
+			}, Qt::QueuedConnection);
+		});
+	};
+
+	startFiles = [&]()
+	{
+		while (!stopping && running < mMaxWorkers && nextFile < fileCount)
+			startFile(nextFile++);
+
+		if (running == 0)
+			eventLoop.quit();
+	};
+
+	// Cancel() is called from the GUI thread, this is queued to the worker and wakes up the event loop
+	connect(this, &mlConvertThread::CancelRequested, &eventLoop, [&]()
+	{
+		stopping = true;
+		success = false;
+
+		for (auto* process : processes)
+		{
+			if (process != nullptr && process->state() != QProcess::NotRunning)
+				process->KillTree();
+		}
+	});
+
+	if (!mCancel)
+		startFiles();
+
+	if (running > 0)
+		eventLoop.exec();
+
+	preparePool.waitForDone();
+	qDeleteAll(processes);
+	if (mUseCache)
+		cache.Save();
+
+	// Cancelled batches and ones stopped by an error stay resumable
+	if (nextLog == fileCount)
+		journal.Finish();
+
+	// After stopping early the files that never started hold back the logs of the ones that finished after them
+	for (auto fileIdx = nextLog; fileIdx < fileCount; fileIdx++)
+	{
+		if (results[fileIdx] != ML_CONVERT_PENDING && !logs[fileIdx].isEmpty())
+			emit OutputReady(logs[fileIdx]);
+	}
+
+	auto convCountSuccess = 0;
+	auto convCountSkipped = 0;
+	auto convCountFailed = 0;
+
+	for (auto result : results)
+	{
+		if (result == ML_CONVERT_SUCCEEDED)
+			convCountSuccess++;
+		else if (result == ML_CONVERT_SKIPPED)
+			convCountSkipped++;
+		else if (result == ML_CONVERT_FAILED)
+			convCountFailed++;
 	}
 
 	mSuccess = success;
@@ -259,17 +1063,45 @@ void mlConvertThread::run()
 			"Files Processed: %1\n"
 			"Successes: %2\n"
 			"Skipped: %3\n"
-			"Failures: %4\n").arg(mFiles.count()).arg(convCountSuccess).arg(convCountSkipped).arg(convCountFailed);
-		emit OutputReady(msg);
+			"Failures: %4\n"
+			"Rejected Before Converting: %5\n").arg(mFiles.count()).arg(convCountSuccess).arg(convCountSkipped).arg(convCountFailed).arg(rejected);
+		const auto checked = QString("Checked: %1 models (%2 vertices, %3 bones), %4 animations (%5 frames), %6 MB\n")
+			.arg(checkedModels).arg(checkedVerts).arg(checkedBones).arg(checkedAnims).arg(checkedFrames)
+			.arg(checkedSize / (1024.0 * 1024.0), 0, 'f', 1);
+		const auto stats = mProgress.Stats(0);
+		auto throughput = QString("Throughput: %1 files/s, %2 MB/s in %3 s\n").arg(stats.FilesPerSecond, 0, 'f', 1)
+			.arg(stats.BytesPerSecond / (1024.0 * 1024.0), 0, 'f', 1).arg(stats.Elapsed / 1000.0, 0, 'f', 1);
+		if (stats.LatencyMax >= 0)
+			throughput += QString("Latency: p50 %1 ms, p95 %2 ms, max %3 ms\n").arg(stats.LatencyP50).arg(stats.LatencyP95).arg(stats.LatencyMax);
+
+		emit OutputReady(msg + checked + throughput);
 	}
 }
 
+mlConvertPlanThread::mlConvertPlanThread(const QList<QUrl>& Urls, const QString& OutputDir, bool MirrorFolders, bool Overwrite)
+	: mUrls(Urls), mOutputDir(OutputDir), mMirrorFolders(MirrorFolders), mOverwrite(Overwrite)
+{
+}
+
+void mlConvertPlanThread::run()
+{
+	mPlan = mlConvertPlan::Create(mUrls, mOutputDir, mMirrorFolders);
+}
+
 mlMainWindow::mlMainWindow(QWidget* parent)
 {
 	auto settings = QSettings{};
 
 	mBuildThread = nullptr;
+	mConvertThread = nullptr;
+	mJournaledConvertThread = nullptr;
+	mWatchConvertThread = nullptr;
+	mLogIndexThread = nullptr;
+	mLogIndexPending = false;
 	mBuildLanguage = settings.value("BuildLanguage", "english").toString();
+	mBuildJobs = settings.value("BuildJobs", QThread::idealThreadCount()).toInt();
+	mLinkShards = settings.value("LinkShards", 1).toInt();
+	mLinkShardJobs = settings.value("LinkShardJobs", 0).toInt();
 	mTreyarchTheme = settings.value("UseDarkTheme", false).toBool();
 
 	// Qt prefers '/' over '\\'
@@ -284,6 +1116,8 @@ mlMainWindow::mlMainWindow(QWidget* parent)
 	resize(1024, 768);
 
 	CreateActions();
+	InitBuildQueueGUI();
+	InitTaskGUI();
 	CreateMenu();
 	CreateToolBar();
 
@@ -345,9 +1179,19 @@ mlMainWindow::mlMainWindow(QWidget* parent)
 	mRunOptionsWidget->setSizePolicy(QSizePolicy::Minimum, QSizePolicy::Minimum);
 	actionsLayout->addWidget(mRunOptionsWidget);
 
+	auto* buildLayout = new QHBoxLayout(parent);
+	actionsLayout->addLayout(buildLayout);
+
 	mBuildButton = new QPushButton("Build");
+	mBuildButton->setToolTip("Build the checked maps and mods, queued behind the current build if one is running");
 	connect(mBuildButton, SIGNAL(clicked()), mActionEditBuild, SLOT(trigger()));
-	actionsLayout->addWidget(mBuildButton);
+	buildLayout->addWidget(mBuildButton);
+
+	mCancelButton = new QPushButton("Cancel");
+	mCancelButton->setToolTip("Cancel the current build, queued builds still run afterwards");
+	mCancelButton->setEnabled(false);
+	connect(mCancelButton, SIGNAL(clicked()), this, SLOT(OnCancelBuild()));
+	buildLayout->addWidget(mCancelButton);
 
 	mDvarsButton = new QPushButton("Dvars");
 	connect(mDvarsButton, SIGNAL(clicked()), this, SLOT(OnEditDvars()));
@@ -360,11 +1204,65 @@ mlMainWindow::mlMainWindow(QWidget* parent)
 	mIgnoreErrorsWidget = new QCheckBox("Ignore Errors");
 	actionsLayout->addWidget(mIgnoreErrorsWidget);
 
+	mForceRebuildWidget = new QCheckBox("Force Rebuild");
+	mForceRebuildWidget->setToolTip("Link zones even if none of their inputs changed since they were last linked.\n"
+	                                "Inputs are the map or mod folder, the GDTs and the files they point to, and the files listed in the zone.\n"
+	                                "Assets the zone only names, like sound aliases, aren't tracked, link with this checked after changing them.");
+	actionsLayout->addWidget(mForceRebuildWidget);
+
 	actionsLayout->addStretch(1);
 
-	mOutputWidget = new QPlainTextEdit(this);
-	mOutputWidget->setReadOnly(true);
-	centralWidget->addWidget(mOutputWidget);
+	auto* outputPanel = new QWidget(this);
+	auto* outputLayout = new QVBoxLayout(outputPanel);
+	outputLayout->setContentsMargins(0, 0, 0, 0);
+
+	auto* logBarLayout = new QHBoxLayout();
+	outputLayout->addLayout(logBarLayout);
+
+	mLogCountsWidget = new QLabel(outputPanel);
+	logBarLayout->addWidget(mLogCountsWidget, 1);
+
+	mFindWidget = new QLineEdit(outputPanel);
+	mFindWidget->setPlaceholderText("Find");
+	mFindWidget->setToolTip("Find text in the console, F3 finds the next match and Shift+F3 the previous one, Ctrl+G goes to a line");
+	mFindWidget->setClearButtonEnabled(true);
+	connect(mFindWidget, SIGNAL(returnPressed()), this, SLOT(OnFindNext()));
+	logBarLayout->addWidget(mFindWidget);
+
+	connect(new QShortcut(QKeySequence::FindNext, this), SIGNAL(activated()), this, SLOT(OnFindNext()));
+	connect(new QShortcut(QKeySequence::FindPrevious, this), SIGNAL(activated()), this, SLOT(OnFindPrevious()));
+	connect(new QShortcut(QKeySequence::Find, this), SIGNAL(activated()), mFindWidget, SLOT(setFocus()));
+	connect(new QShortcut(QKeySequence(Qt::CTRL + Qt::Key_G), this), SIGNAL(activated()), this, SLOT(OnGoToLine()));
+
+	mPreviousErrorButton = new QPushButton("Previous Error");
+	mPreviousErrorButton->setToolTip("Select the error before the cursor in the console");
+	connect(mPreviousErrorButton, SIGNAL(clicked()), this, SLOT(OnPreviousError()));
+	logBarLayout->addWidget(mPreviousErrorButton);
+
+	mNextErrorButton = new QPushButton("Next Error");
+	mNextErrorButton->setToolTip("Select the error after the cursor in the console");
+	connect(mNextErrorButton, SIGNAL(clicked()), this, SLOT(OnNextError()));
+	logBarLayout->addWidget(mNextErrorButton);
+
+	// The console shows the session log from disk, the sink only says when there's more of it
+	mOutputWidget = new mlLogView(outputPanel);
+	connect(&mOutputSink, SIGNAL(TextReady(QString)), this, SLOT(UpdateOutput()));
+	outputLayout->addWidget(mOutputWidget);
+
+	StartLogSession("launcher");
+	centralWidget->addWidget(outputPanel);
+
+	// The log index is brought up to date a little after logs were added, so a burst of them is indexed in one go
+	mLogIndexTimer.setSingleShot(true);
+	mLogIndexTimer.setInterval(2000);
+	connect(&mLogIndexTimer, SIGNAL(timeout()), this, SLOT(UpdateLogIndex()));
+	connect(&mLogsWatcher, SIGNAL(directoryChanged(QString)), &mLogIndexTimer, SLOT(start()));
+
+	// The watcher ignores folders that don't exist, so they're created first
+	const auto sessionsPath = LogsPath() + "/sessions";
+	QDir{}.mkpath(sessionsPath);
+	mLogsWatcher.addPaths(QStringList() << LogsPath() << sessionsPath);
+	mLogIndexTimer.start();
 
 	setCentralWidget(centralWidget);
 
@@ -383,6 +1281,17 @@ mlMainWindow::mlMainWindow(QWidget* parent)
 	restoreState(settings.value("State").toByteArray());
 	settings.endGroup();
 
+	// Builds that were still queued when the launcher was closed wait for the user to start or discard them
+	mBuildQueue.Load(mGamePath, mToolsPath);
+	UpdateBuildQueue();
+	if (mBuildQueue.PausedCount() > 0)
+		mBuildQueueWidget->show();
+
+	// The watch folder keeps working while the Export2Bin dock is closed
+	connect(&mExportWatcher, SIGNAL(FilesReady(QStringList)), this, SLOT(OnExport2BinWatchFilesReady(QStringList)));
+	if (settings.value("Export2Bin_Watch", false).toBool())
+		mExportWatcher.Start(settings.value("Export2Bin_WatchDir").toString());
+
 	SteamAPI_Init();
 
 	connect(&mTimer, SIGNAL(timeout()), this, SLOT(SteamUpdate()));
@@ -421,6 +1330,13 @@ void mlMainWindow::CreateActions()
 	mActionEditPublish->setShortcut(QKeySequence("Ctrl+P"));
 	connect(mActionEditPublish, SIGNAL(triggered()), this, SLOT(OnEditPublish()));
 
+	mActionEditBuildHistory = new QAction("Build &History...", this);
+	connect(mActionEditBuildHistory, SIGNAL(triggered()), this, SLOT(OnEditBuildHistory()));
+
+	mActionEditSearchLogs = new QAction("&Search Logs...", this);
+	mActionEditSearchLogs->setShortcut(QKeySequence(Qt::CTRL + Qt::SHIFT + Qt::Key_F));
+	connect(mActionEditSearchLogs, SIGNAL(triggered()), this, SLOT(OnSearchLogs()));
+
 	mActionEditOptions = new QAction("&Options...", this);
 	connect(mActionEditOptions, SIGNAL(triggered()), this, SLOT(OnEditOptions()));
 
@@ -445,6 +1361,10 @@ void mlMainWindow::CreateMenu()
 	auto* editMenu = new QMenu("&Edit", menuBar);
 	editMenu->addAction(mActionEditBuild);
 	editMenu->addAction(mActionEditPublish);
+	editMenu->addAction(mActionEditBuildHistory);
+	editMenu->addAction(mActionEditSearchLogs);
+	editMenu->addAction(mBuildQueueWidget->toggleViewAction());
+	editMenu->addAction(mTaskWidget->toggleViewAction());
 	editMenu->addSeparator();
 	editMenu->addAction(mActionEditOptions);
 	menuBar->addAction(editMenu->menuAction());
@@ -517,6 +1437,64 @@ void mlMainWindow::InitExport2BinGUI()
 
 	gridLayout->addLayout(dirLayout, 2, 0);
 
+	auto* workersLayout = new QHBoxLayout();
+	workersLayout->addWidget(new QLabel("Workers:", widget));
+
+	mExport2BinWorkersWidget = new QSpinBox(widget);
+	mExport2BinWorkersWidget->setToolTip("Number of files converted at the same time");
+	mExport2BinWorkersWidget->setRange(1, qMax(QThread::idealThreadCount(), 1) * 4);
+	mExport2BinWorkersWidget->setValue(Settings.value("Export2Bin_Workers", QThread::idealThreadCount()).toInt());
+	workersLayout->addWidget(mExport2BinWorkersWidget);
+	workersLayout->addStretch(1);
+
+	connect(mExport2BinWorkersWidget, SIGNAL(valueChanged(int)), this, SLOT(OnExport2BinSetWorkers()));
+
+	gridLayout->addLayout(workersLayout, 3, 0);
+
+	auto* watchLayout = new QHBoxLayout();
+	mExport2BinWatchWidget = new QCheckBox("Watch Folder:", widget);
+	mExport2BinWatchWidget->setToolTip("Convert exports saved to this folder as soon as they're written");
+	mExport2BinWatchWidget->setChecked(mExportWatcher.IsWatching());
+	mExport2BinWatchDirWidget = new QLineEdit(widget);
+	mExport2BinWatchDirWidget->setText(Settings.value("Export2Bin_WatchDir").toString());
+	auto* watchBrowseButton = new QToolButton(widget);
+	watchBrowseButton->setText("...");
+	watchBrowseButton->setSizePolicy(QSizePolicy::Fixed, QSizePolicy::Fixed);
+
+	connect(mExport2BinWatchWidget, SIGNAL(clicked()), this, SLOT(OnExport2BinToggleWatch()));
+	connect(watchBrowseButton, SIGNAL(clicked()), this, SLOT(OnExport2BinChooseWatchDirectory()));
+
+	watchLayout->addWidget(mExport2BinWatchWidget);
+	watchLayout->addWidget(mExport2BinWatchDirWidget);
+	watchLayout->addWidget(watchBrowseButton);
+
+	gridLayout->addLayout(watchLayout, 4, 0);
+
+	mExport2BinMirrorFoldersWidget = new QCheckBox("&Mirror Subfolders", widget);
+	mExport2BinMirrorFoldersWidget->setToolTip("Keep the folder structure of dropped folders in the output directory");
+	mExport2BinMirrorFoldersWidget->setChecked(Settings.value("Export2Bin_MirrorFolders", false).toBool());
+	gridLayout->addWidget(mExport2BinMirrorFoldersWidget, 5, 0);
+
+	connect(mExport2BinMirrorFoldersWidget, SIGNAL(clicked()), this, SLOT(OnExport2BinToggleMirrorFolders()));
+
+	mExport2BinResumeWidget = new QPushButton("&Resume Last Batch", widget);
+	mExport2BinResumeWidget->setToolTip("Convert the files the last batch didn't get to before it was cancelled or the launcher closed");
+	gridLayout->addWidget(mExport2BinResumeWidget, 6, 0);
+
+	connect(mExport2BinResumeWidget, SIGNAL(clicked()), this, SLOT(OnExport2BinResumeBatch()));
+
+	mExport2BinProgressWidget = new QProgressBar(widget);
+	mExport2BinProgressWidget->setRange(0, 1);
+	mExport2BinProgressWidget->setValue(0);
+	gridLayout->addWidget(mExport2BinProgressWidget, 7, 0);
+
+	mExport2BinStatsWidget = new QLabel(widget);
+	mExport2BinStatsWidget->setTextInteractionFlags(Qt::TextSelectableByMouse);
+	gridLayout->addWidget(mExport2BinStatsWidget, 8, 0);
+
+	mExport2BinProgressTimer.setInterval(500);
+	connect(&mExport2BinProgressTimer, SIGNAL(timeout()), this, SLOT(OnExport2BinUpdateProgress()));
+
 	groupBox->setAcceptDrops(true);
 
 	dock->resize(QSize(256, 256));
@@ -524,8 +1502,103 @@ void mlMainWindow::InitExport2BinGUI()
 	mExport2BinGUIWidget = dock;
 }
 
+void mlMainWindow::InitBuildQueueGUI()
+{
+	mBuildQueueWidget = new QDockWidget("Build Queue", this);
+	mBuildQueueWidget->setObjectName(QStringLiteral("BuildQueueDock"));
+	mBuildQueueWidget->toggleViewAction()->setText("Build &Queue");
+
+	auto* widget = new QWidget(mBuildQueueWidget);
+	auto* layout = new QVBoxLayout(widget);
+	mBuildQueueWidget->setWidget(widget);
+
+	mBuildQueuePausedWidget = new QWidget(widget);
+	layout->addWidget(mBuildQueuePausedWidget);
+
+	auto* pausedLayout = new QHBoxLayout(mBuildQueuePausedWidget);
+	pausedLayout->setContentsMargins(0, 0, 0, 0);
+	pausedLayout->addWidget(new QLabel("Builds from the last session are paused", mBuildQueuePausedWidget), 1);
+
+	auto* resumeButton = new QPushButton("Start", mBuildQueuePausedWidget);
+	resumeButton->setToolTip("Queue the paused builds");
+	connect(resumeButton, SIGNAL(clicked()), this, SLOT(OnBuildQueueResume()));
+	pausedLayout->addWidget(resumeButton);
+
+	auto* discardButton = new QPushButton("Discard", mBuildQueuePausedWidget);
+	discardButton->setToolTip("Remove the paused builds from the queue");
+	connect(discardButton, SIGNAL(clicked()), this, SLOT(OnBuildQueueDiscard()));
+	pausedLayout->addWidget(discardButton);
+
+	mBuildQueueListWidget = new QListWidget(widget);
+	layout->addWidget(mBuildQueueListWidget);
+
+	auto* buttonsLayout = new QHBoxLayout();
+	layout->addLayout(buttonsLayout);
+
+	auto* moveUpButton = new QPushButton("Move Up", widget);
+	connect(moveUpButton, SIGNAL(clicked()), this, SLOT(OnBuildQueueMoveUp()));
+	buttonsLayout->addWidget(moveUpButton);
+
+	auto* moveDownButton = new QPushButton("Move Down", widget);
+	connect(moveDownButton, SIGNAL(clicked()), this, SLOT(OnBuildQueueMoveDown()));
+	buttonsLayout->addWidget(moveDownButton);
+
+	auto* removeButton = new QPushButton("Remove", widget);
+	removeButton->setToolTip("Remove the selected build from the queue, or cancel it if it's already running");
+	connect(removeButton, SIGNAL(clicked()), this, SLOT(OnBuildQueueRemove()));
+	buttonsLayout->addWidget(removeButton);
+
+	addDockWidget(Qt::RightDockWidgetArea, mBuildQueueWidget);
+	mBuildQueueWidget->hide();
+}
+
+void mlMainWindow::InitTaskGUI()
+{
+	mTaskWidget = new QDockWidget("Tasks", this);
+	mTaskWidget->setObjectName(QStringLiteral("TaskDock"));
+	mTaskWidget->toggleViewAction()->setText("&Tasks");
+
+	auto* widget = new QWidget(mTaskWidget);
+	auto* layout = new QVBoxLayout(widget);
+	mTaskWidget->setWidget(widget);
+
+	mTaskListWidget = new QTreeWidget(widget);
+	mTaskListWidget->setHeaderLabels(QStringList() << "Task" << "Status" << "Time");
+	mTaskListWidget->setRootIsDecorated(false);
+	mTaskListWidget->setUniformRowHeights(true);
+	layout->addWidget(mTaskListWidget);
+
+	auto* buttonsLayout = new QHBoxLayout();
+	layout->addLayout(buttonsLayout);
+	buttonsLayout->addStretch(1);
+
+	auto* cancelButton = new QPushButton("Cancel", widget);
+	cancelButton->setToolTip("Cancel the selected task");
+	connect(cancelButton, SIGNAL(clicked()), this, SLOT(OnTaskCancel()));
+	buttonsLayout->addWidget(cancelButton);
+
+	// Only polled while there's something to look at
+	mTaskTimer.setInterval(500);
+	connect(&mTaskTimer, SIGNAL(timeout()), this, SLOT(UpdateTaskList()));
+	connect(mTaskWidget, SIGNAL(visibilityChanged(bool)), this, SLOT(UpdateTaskList()));
+	connect(&mTasks, SIGNAL(TaskStarted(int)), this, SLOT(UpdateTaskList()));
+	connect(&mTasks, SIGNAL(TaskFinished(int)), this, SLOT(UpdateTaskList()));
+
+	addDockWidget(Qt::RightDockWidgetArea, mTaskWidget);
+	mTaskWidget->hide();
+}
+
 void mlMainWindow::closeEvent(QCloseEvent* Event)
 {
+	if (mTasks.RunningCount() > 0 && QMessageBox::question(this, "Quit", "Background tasks are still running, cancel them and quit?",
+	                                                       QMessageBox::Yes | QMessageBox::No) != QMessageBox::Yes)
+	{
+		Event->ignore();
+		return;
+	}
+
+	mTasks.CancelAll();
+
 	auto settings = QSettings{};
 	settings.beginGroup("MainWindow");
 	settings.setValue("Geometry", saveGeometry());
@@ -542,33 +1615,140 @@ void mlMainWindow::SteamUpdate()
 
 void mlMainWindow::UpdateDB()
 {
-	if (mBuildThread != nullptr)
+	auto job = mlBuildJob{};
+	job.Type = ML_JOB_UPDATE_DB;
+	job.Options.GamePath = mGamePath;
+	job.Options.ToolsPath = mToolsPath;
+	job.IgnoreErrors = false;
+	job.ForceRebuild = false;
+
+	EnqueueBuild(job);
+}
+
+void mlMainWindow::EnqueueBuild(const mlBuildJob& Job)
+{
+	const auto busy = mBuildThread != nullptr || !mBuildQueue.IsEmpty();
+	const auto result = mBuildQueue.Enqueue(Job);
+
+	if (busy)
+	{
+		switch (result)
+		{
+		case ML_ENQUEUE_ADDED:
+			mOutputSink.Append(QString("Queued %1").arg(Job.Description()));
+			break;
+
+		case ML_ENQUEUE_MERGED:
+			mOutputSink.Append(QString("Queued %1, merged with a build that was already queued").arg(Job.Description()));
+			break;
+
+		case ML_ENQUEUE_DUPLICATE:
+			mOutputSink.Append(QString("%1 is already queued").arg(Job.Description()));
+			break;
+		}
+
+		mBuildQueueWidget->show();
+	}
+
+	UpdateBuildQueue();
+	StartNextBuild(!busy);
+}
+
+void mlMainWindow::StartNextBuild(bool ClearOutput)
+{
+	if (mBuildThread != nullptr || !mBuildQueue.Start())
 		return;
 
-	QList<QPair<QString, QStringList>> Commands;
-	Commands.append(QPair<QString, QStringList>(QString("%1/gdtdb/gdtdb.exe").arg(mToolsPath),
-	                                            QStringList() << "/update"));
+	const auto& job = mBuildQueue.Job(0);
+
+	// Queued builds that run right after each other share a session, like they share the console
+	if (ClearOutput)
+	{
+		StartLogSession("build");
+		mOutputSink.Clear();
+	}
+	else
+		mOutputSink.Append(QString("\n---------- %1 ----------").arg(job.Description()));
+
+	StartBuildThread(job.CreateGraph(), job.IgnoreErrors, job.ForceRebuild, job.Description());
+	UpdateBuildQueue();
+}
+
+void mlMainWindow::UpdateBuildQueue() const
+{
+	const auto currentRow = mBuildQueueListWidget->currentRow();
+	mBuildQueueListWidget->clear();
+
+	for (auto jobIdx = 0; jobIdx < mBuildQueue.Count(); jobIdx++)
+	{
+		const auto running = jobIdx == 0 && mBuildQueue.IsRunning();
+		auto* item = new QListWidgetItem(mBuildQueue.Job(jobIdx).Description(), mBuildQueueListWidget);
+
+		if (running)
+		{
+			auto font = item->font();
+			font.setBold(true);
+			item->setFont(font);
+			item->setText(item->text() + " - building");
+		}
+	}
+
+	for (auto jobIdx = 0; jobIdx < mBuildQueue.PausedCount(); jobIdx++)
+	{
+		auto* item = new QListWidgetItem(mBuildQueue.PausedJob(jobIdx).Description() + " - paused", mBuildQueueListWidget);
+
+		auto font = item->font();
+		font.setItalic(true);
+		item->setFont(font);
+	}
 
-	StartBuildThread(Commands);
+	mBuildQueuePausedWidget->setVisible(mBuildQueue.PausedCount() > 0);
+	mBuildQueueListWidget->setCurrentRow(qMin(currentRow, mBuildQueueListWidget->count() - 1));
 }
 
-void mlMainWindow::StartBuildThread(const QList<QPair<QString, QStringList>>& Commands)
+void mlMainWindow::StartBuildThread(const mlBuildGraph& Graph, bool IgnoreErrors, bool ForceRebuild, const QString& Description)
 {
-	mBuildButton->setText("Cancel");
-	mOutputWidget->clear();
+	mCancelButton->setEnabled(true);
 
-	mBuildThread = new mlBuildThread(Commands, mIgnoreErrorsWidget->isChecked());
-	connect(mBuildThread, SIGNAL(OutputReady(QString)), this, SLOT(BuildOutputReady(QString)));
+	mBuildThread = new mlBuildThread(Graph, mBuildJobs, mlResourceLimits::FromSettings(), IgnoreErrors, ForceRebuild);
+	connect(mBuildThread, SIGNAL(OutputReady(QString)), &mOutputSink, SLOT(Append(QString)), Qt::DirectConnection);
 	connect(mBuildThread, SIGNAL(finished()), this, SLOT(BuildFinished()));
-	mBuildThread->start();
+	mTasks.Start(mBuildThread, Description);
+}
+
+// Batches run alongside builds and each other, the dock shows the progress of the one started last. Only the first of
+// the batches running at the same time is journaled, the others would overwrite its records.
+void mlMainWindow::StartConvertThread(QStringList& pathList, QString& outputDir, bool allowOverwrite, const QStringList& outputDirs)
+{
+	mConvertThread = new mlConvertThread(pathList, outputDir, true, allowOverwrite, mExport2BinWorkersWidget->value(), outputDirs);
+
+	if (mJournaledConvertThread == nullptr)
+	{
+		mJournaledConvertThread = mConvertThread;
+		mConvertThread->SetJournaled(true);
+	}
+	else
+	{
+		mOutputSink.Append("Export2Bin: Another batch is still running, this one can't be resumed if it's cut short");
+	}
+
+	connect(mConvertThread, SIGNAL(OutputReady(QString)), &mOutputSink, SLOT(Append(QString)), Qt::DirectConnection);
+	connect(mConvertThread, SIGNAL(finished()), this, SLOT(OnExport2BinConvertFinished()));
+	mTasks.Start(mConvertThread, QString("Export2Bin %1 files").arg(pathList.count()));
+
+	mExport2BinProgressTimer.start();
 }
 
-void mlMainWindow::StartConvertThread(QStringList& pathList, QString& outputDir, bool allowOverwrite)
+void mlMainWindow::PlanConvert(const QList<QUrl>& Urls)
 {
-	mConvertThread = new mlConvertThread(pathList, outputDir, true, allowOverwrite);
-	connect(mConvertThread, SIGNAL(OutputReady(QString)), this, SLOT(BuildOutputReady(QString)));
-	connect(mConvertThread, SIGNAL(finished()), this, SLOT(BuildFinished()));
-	mConvertThread->start();
+	if (mTasks.RunningCount() == 0)
+		StartLogSession("export2bin");
+	mOutputSink.Append("Export2Bin: Planning...");
+
+	auto* planThread = new mlConvertPlanThread(Urls, mExport2BinTargetDirWidget->text(), mExport2BinMirrorFoldersWidget->isChecked(),
+	                                           mExport2BinOverwriteWidget->isChecked());
+	connect(planThread, SIGNAL(finished()), this, SLOT(OnExport2BinPlanReady()));
+	planThread->start();
 }
 
 void mlMainWindow::PopulateFileList() const
@@ -829,26 +2009,9 @@ void mlMainWindow::OnFileNew()
 
 void mlMainWindow::OnEditBuild()
 {
-	if (mBuildThread != nullptr)
-	{
-		mBuildThread->Cancel();
-		return;
-	}
-
-	auto commands = QList<QPair<QString, QStringList>>{};
-	auto updateAdded = false;
-
-	auto addUpdateDbCommand = [&]()
-	{
-		if (!updateAdded)
-		{
-			commands.append(QPair<QString, QStringList>(QString("%1/gdtdb/gdtdb.exe").arg(mToolsPath),
-			                                            QStringList() << "/update"));
-			updateAdded = true;
-		}
-	};
-
-	auto checkedItems = QList<QTreeWidgetItem*>{};
+	auto options = mlBuildOptions{};
+	options.GamePath = mGamePath;
+	options.ToolsPath = mToolsPath;
 
 	std::function<void (QTreeWidgetItem*)> searchCheckedItems = [&](QTreeWidgetItem* ParentItem) -> void
 	{
@@ -857,7 +2020,10 @@ void mlMainWindow::OnEditBuild()
 			auto* child = ParentItem->child(childIdx);
 			if (child->checkState(0) == Qt::Checked)
 			{
-				checkedItems.append(child);
+				if (child->data(0, Qt::UserRole).toInt() == ML_ITEM_MAP)
+					options.Maps.append(child->text(0));
+				else
+					options.ModZones.append(QPair<QString, QString>(child->parent()->text(0), child->text(0)));
 			}
 			else
 			{
@@ -867,137 +2033,39 @@ void mlMainWindow::OnEditBuild()
 	};
 
 	searchCheckedItems(mFileListWidget->invisibleRootItem());
-	auto lastMap = QString{};
-	auto lastMod = QString{};
-
-	auto languageArgs = QStringList{};
-
-	if (mBuildLanguage != "All")
-	{
-		languageArgs << "-language" << mBuildLanguage;
-	}
-	else
-	{
-		for (const auto& language : gLanguages)
-		{
-			languageArgs << "-language" << language;
-		}
-	}
-
-	for (auto* item : checkedItems)
-	{
-		if (item->data(0, Qt::UserRole).toInt() == ML_ITEM_MAP)
-		{
-			auto mapName = item->text(0);
-
-			if (mCompileEnabledWidget->isChecked())
-			{
-				addUpdateDbCommand();
-
-				auto args = QStringList{};
-				args << "-platform" << "pc";
-
-				if (mCompileModeWidget->currentIndex() == 0)
-				{
-					args << "-onlyents";
-				}
-				else
-				{
-					args << "-navmesh" << "-navvolume";
-				}
-
-				args << "-loadFrom" << QString(R"(%1\map_source\%2\%3.map)").arg(mGamePath, mapName.left(2), mapName);
-				args << QString(R"(%1\share\raw\maps\%2\%3.d3dbsp)").arg(mGamePath, mapName.left(2), mapName);
-
-				commands.append(QPair<QString, QStringList>(QString("%1\\bin\\cod2map64.exe").arg(mToolsPath), args));
-			}
-
-			if (mLightEnabledWidget->isChecked())
-			{
-				addUpdateDbCommand();
-
-				auto args = QStringList{};
-				args << "-ledSilent";
-
-				switch (mLightQualityWidget->currentIndex())
-				{
-				case 0:
-					args << "+low";
-					break;
-
-				default:
-				case 1:
-					args << "+medium";
-					break;
-
-				case 2:
-					args << "+high";
-					break;
-				}
-
-				args << "+localprobes" << "+forceclean" << "+recompute" << QString("%1/map_source/%2/%3.map").arg(mGamePath, mapName.left(2), mapName);
-				commands.append(QPair<QString, QStringList>(QString("%1/bin/radiant_modtools.exe").arg(mToolsPath), args));
-			}
-
-			if (mLinkEnabledWidget->isChecked())
-			{
-				addUpdateDbCommand();
-				commands.append(QPair<QString, QStringList>(QString("%1/bin/linker_modtools.exe").arg(mToolsPath), QStringList() << languageArgs << "-modsource" << mapName));
-			}
-
-			lastMap = mapName;
-		}
-		else
-		{
-			auto modName = item->parent()->text(0);
-
-			if (mLinkEnabledWidget->isChecked())
-			{
-				addUpdateDbCommand();
-
-				auto zoneName = item->text(0);
-				commands.append(QPair<QString, QStringList>(QString("%1/bin/linker_modtools.exe").arg(mToolsPath),
-				                                            QStringList() << languageArgs << "-fs_game" << modName <<
-				                                            "-modsource" << zoneName));
-			}
-
-			lastMod = modName;
-		}
-	}
-
-	if (mRunEnabledWidget->isChecked() && (!lastMod.isEmpty() || !lastMap.isEmpty()))
-	{
-		auto args = QStringList{};
-
-		if (!mRunDvars.isEmpty())
-		{
-			args << mRunDvars;
-		}
-
-		args << "+set" << "fs_game" << (lastMod.isEmpty() ? lastMap : lastMod);
-
-		if (!lastMap.isEmpty())
-		{
-			args << "+devmap" << lastMap;
-		}
-
-		const auto extraOptions = mRunOptionsWidget->text();
-		if (!extraOptions.isEmpty())
-		{
-			args << extraOptions.split(' ');
-		}
 
-		commands.append(QPair<QString, QStringList>(QString("%1BlackOps3.exe").arg(mGamePath), args));
-	}
+	options.Compile = mCompileEnabledWidget->isChecked();
+	options.CompileEntsOnly = mCompileModeWidget->currentIndex() == 0;
+	options.Light = mLightEnabledWidget->isChecked();
+	options.LightQuality = mLightQualityWidget->currentIndex();
+	options.Link = mLinkEnabledWidget->isChecked();
+	options.Language = mBuildLanguage;
+	options.LinkShards = mLinkShards;
+	options.LinkShardJobs = mLinkShardJobs;
+	options.Run = mRunEnabledWidget->isChecked();
+	options.RunDvars = mRunDvars;
+	options.RunOptions = mRunOptionsWidget->text();
 
-	if (commands.empty() && !updateAdded)
+	if (mlBuildGraph::Create(options).IsEmpty())
 	{
 		QMessageBox::information(this, "No Tasks",
 		                         "Please selected at least one file from the list and one action to be performed.");
 		return;
 	}
 
-	StartBuildThread(commands);
+	auto job = mlBuildJob{};
+	job.Type = ML_JOB_BUILD;
+	job.Options = options;
+	job.IgnoreErrors = mIgnoreErrorsWidget->isChecked();
+	job.ForceRebuild = mForceRebuildWidget->isChecked();
+
+	EnqueueBuild(job);
+}
+
+void mlMainWindow::OnCancelBuild()
+{
+	if (mBuildThread != nullptr)
+		mBuildThread->Cancel();
 }
 
 void mlMainWindow::OnEditPublish()
@@ -1230,36 +2298,354 @@ void mlMainWindow::OnEditOptions()
 		languages << gLanguage;
 	}
 
-	auto* languageCombo = new QComboBox();
-	languageCombo->addItems(languages);
-	languageCombo->setCurrentText(mBuildLanguage);
-	languageCombo->setStyle(QStyleFactory::create("windows"));
-	languageLayout->addWidget(languageCombo);
+	auto* languageCombo = new QComboBox();
+	languageCombo->addItems(languages);
+	languageCombo->setCurrentText(mBuildLanguage);
+	languageCombo->setStyle(QStyleFactory::create("windows"));
+	languageLayout->addWidget(languageCombo);
+
+	layout->addLayout(languageLayout);
+
+	auto* jobsLayout = new QHBoxLayout();
+	jobsLayout->addWidget(new QLabel("Build Jobs:"));
+
+	auto* jobsSpinBox = new QSpinBox();
+	jobsSpinBox->setToolTip("Maximum number of tools run at the same time when building independent maps and zones");
+	jobsSpinBox->setRange(1, qMax(QThread::idealThreadCount(), 1) * 2);
+	jobsSpinBox->setValue(mBuildJobs);
+	jobsLayout->addWidget(jobsSpinBox);
+
+	layout->addLayout(jobsLayout);
+
+	auto* shardsLayout = new QHBoxLayout();
+	shardsLayout->addWidget(new QLabel("Link Shards:"));
+
+	auto* shardsSpinBox = new QSpinBox();
+	shardsSpinBox->setToolTip("Number of linker runs the languages are split over when the build language is \"All\", 1 links all of them in a single run");
+	shardsSpinBox->setRange(1, static_cast<int>(ARRAYSIZE(gLanguages)));
+	shardsSpinBox->setValue(mLinkShards);
+	shardsLayout->addWidget(shardsSpinBox);
+
+	shardsLayout->addWidget(new QLabel("Max At Once:"));
+
+	auto* shardJobsSpinBox = new QSpinBox();
+	shardJobsSpinBox->setToolTip("Maximum number of link shards run at the same time, \"No Limit\" only limits them by the build jobs");
+	shardJobsSpinBox->setRange(0, static_cast<int>(ARRAYSIZE(gLanguages)));
+	shardJobsSpinBox->setSpecialValueText("No Limit");
+	shardJobsSpinBox->setValue(mLinkShardJobs);
+	shardsLayout->addWidget(shardJobsSpinBox);
+
+	layout->addLayout(shardsLayout);
+
+	// Heavy tools like lighting and navmesh compiles only run side by side while their learned costs fit in here
+	const auto limits = mlResourceLimits::FromSettings();
+	const auto megabyte = 1024 * 1024;
+
+	auto* budgetLayout = new QHBoxLayout();
+	budgetLayout->addWidget(new QLabel("Tool Cores:"));
+
+	auto* coresSpinBox = new QSpinBox();
+	coresSpinBox->setToolTip("Number of cores the tools of a build may use together, heavy tools wait until enough of them are free");
+	coresSpinBox->setRange(1, qMax(QThread::idealThreadCount(), 1) * 2);
+	coresSpinBox->setValue(qRound(limits.Cores));
+	budgetLayout->addWidget(coresSpinBox);
+
+	budgetLayout->addWidget(new QLabel("Tool Memory:"));
+
+	auto* memorySpinBox = new QSpinBox();
+	memorySpinBox->setToolTip("Memory the tools of a build may use together, heavy tools wait until enough of it is free");
+	memorySpinBox->setRange(1, qMax(static_cast<int>(mlResourceLimits::PhysicalMemory() / (1024 * megabyte)), 1) * 2);
+	memorySpinBox->setSuffix(" GB");
+	memorySpinBox->setValue(qMax(static_cast<int>(limits.Memory / (1024 * megabyte)), 1));
+	budgetLayout->addWidget(memorySpinBox);
+
+	layout->addLayout(budgetLayout);
+
+	auto* lowPriorityCheckBox = new QCheckBox("Run Tools at Low Priority");
+	lowPriorityCheckBox->setToolTip("Run the tools below normal priority so Radiant and the game stay responsive while building");
+	lowPriorityCheckBox->setChecked(limits.LowPriority);
+	layout->addWidget(lowPriorityCheckBox);
+
+	auto* buttonBox = new QDialogButtonBox(&dialog);
+	buttonBox->setOrientation(Qt::Horizontal);
+	buttonBox->setStandardButtons(QDialogButtonBox::Ok | QDialogButtonBox::Cancel);
+	buttonBox->setCenterButtons(true);
+
+	layout->addWidget(buttonBox);
+
+	connect(buttonBox, SIGNAL(accepted()), &dialog, SLOT(accept()));
+	connect(buttonBox, SIGNAL(rejected()), &dialog, SLOT(reject()));
+
+	if (dialog.exec() != QDialog::Accepted)
+	{
+		return;
+	}
+
+	mBuildLanguage = languageCombo->currentText();
+	mBuildJobs = jobsSpinBox->value();
+	mLinkShards = shardsSpinBox->value();
+	mLinkShardJobs = shardJobsSpinBox->value();
+	mTreyarchTheme = checkBox->isChecked();
+
+	settings.setValue("BuildLanguage", mBuildLanguage);
+	settings.setValue("BuildJobs", mBuildJobs);
+	settings.setValue("LinkShards", mLinkShards);
+	settings.setValue("LinkShardJobs", mLinkShardJobs);
+	settings.setValue("GovernorCores", coresSpinBox->value());
+	settings.setValue("GovernorMemory", static_cast<qint64>(memorySpinBox->value()) * 1024);
+	settings.setValue("LowToolPriority", lowPriorityCheckBox->isChecked());
+	settings.setValue("UseDarkTheme", mTreyarchTheme);
+
+	UpdateTheme();
+}
+
+void mlMainWindow::OnEditBuildHistory()
+{
+	auto dialog = QDialog{this, Qt::WindowTitleHint | Qt::WindowSystemMenuHint | Qt::WindowCloseButtonHint};
+	dialog.setWindowTitle("Build History");
+	dialog.resize(800, 500);
+
+	auto* layout = new QVBoxLayout(&dialog);
+
+	auto* historyTree = new QTreeWidget(&dialog);
+	historyTree->setColumnCount(7);
+	historyTree->setHeaderLabels(QStringList() << "Map / Mod" << "Runs" << "Last" << "Median" << "Best" << "Trend" << "Last Run");
+	historyTree->header()->setSectionResizeMode(0, QHeaderView::ResizeToContents);
+	layout->addWidget(historyTree);
+
+	auto formatDuration = [](qint64 Milliseconds)
+	{
+		if (Milliseconds < 10000)
+			return QString("%1 ms").arg(Milliseconds);
+
+		const auto seconds = Milliseconds / 1000;
+		return seconds < 60 ? QString("%1 s").arg(seconds) : QString("%1m %2s").arg(seconds / 60).arg(seconds % 60);
+	};
+
+	// Group by map or mod, then by tool, newest runs first
+	auto targets = QMap<QString, QMap<QString, QList<mlBuildRecord>>>{};
+	for (const auto& record : mlBuildHistory::Load())
+	{
+		targets[record.Target.isEmpty() ? "(all)" : record.Target][record.Tool].prepend(record);
+	}
+
+	for (auto targetIt = targets.begin(); targetIt != targets.end(); ++targetIt)
+	{
+		auto* targetItem = new QTreeWidgetItem(historyTree, QStringList() << targetIt.key());
+		auto font = targetItem->font(0);
+		font.setBold(true);
+		targetItem->setFont(0, font);
+
+		for (auto toolIt = targetIt->begin(); toolIt != targetIt->end(); ++toolIt)
+		{
+			const auto& runs = toolIt.value();
+			const auto& last = runs.first();
+
+			auto durations = QVector<qint64>{};
+			for (auto runIdx = 1; runIdx < runs.count() && runIdx <= 10; runIdx++)
+			{
+				if (runs[runIdx].ExitCode == 0)
+					durations.append(runs[runIdx].Duration);
+			}
+
+			auto best = last.Duration;
+			for (const auto& run : runs)
+			{
+				if (run.ExitCode == 0)
+					best = qMin(best, run.Duration);
+			}
+
+			// Compare the latest run against the median of the 10 runs before it, so one slow build stands out
+			auto median = last.Duration;
+			auto trend = QString{};
+			auto trendColor = QColor{};
+
+			if (!durations.isEmpty())
+			{
+				std::sort(durations.begin(), durations.end());
+				median = durations[durations.count() / 2];
+
+				if (median > 0)
+				{
+					const auto change = (last.Duration - median) * 100 / median;
+					trend = QString("%1%2%").arg(change >= 0 ? "+" : "").arg(change);
+
+					if (change >= 20)
+						trendColor = Qt::red;
+					else if (change <= -20)
+						trendColor = Qt::darkGreen;
+				}
+			}
+
+			auto* toolItem = new QTreeWidgetItem(targetItem, QStringList() << toolIt.key() << QString::number(runs.count())
+				<< formatDuration(last.Duration) << formatDuration(median) << formatDuration(best) << trend
+				<< last.Start.toString("yyyy-MM-dd hh:mm"));
+
+			if (trendColor.isValid())
+				toolItem->setForeground(5, trendColor);
+
+			for (auto runIdx = 0; runIdx < runs.count() && runIdx < 50; runIdx++)
+			{
+				const auto& run = runs[runIdx];
+
+				auto details = QString("exit code %1, %2 KB output").arg(run.ExitCode).arg(run.OutputSize / 1024);
+				if (run.PeakMemory >= 0)
+					details += QString(", %1 MB peak memory").arg(run.PeakMemory / (1024 * 1024));
+
+				auto* runItem = new QTreeWidgetItem(toolItem, QStringList() << run.Start.toString("yyyy-MM-dd hh:mm:ss")
+					<< QString() << formatDuration(run.Duration) << QString() << QString() << details);
+				runItem->setToolTip(0, run.Arguments.join(' '));
+
+				if (run.ExitCode != 0)
+					runItem->setForeground(2, Qt::red);
+			}
+		}
+
+		targetItem->setExpanded(true);
+	}
+
+	auto* buttonBox = new QDialogButtonBox(&dialog);
+	buttonBox->setOrientation(Qt::Horizontal);
+	buttonBox->setStandardButtons(QDialogButtonBox::Close);
+	buttonBox->setCenterButtons(true);
+
+	layout->addWidget(buttonBox);
+
+	connect(buttonBox, SIGNAL(rejected()), &dialog, SLOT(reject()));
+
+	dialog.exec();
+}
+
+void mlMainWindow::OnSearchLogs()
+{
+	auto dialog = QDialog{this, Qt::WindowTitleHint | Qt::WindowSystemMenuHint | Qt::WindowCloseButtonHint};
+	dialog.setWindowTitle("Search Logs");
+	dialog.resize(900, 500);
+
+	auto* layout = new QVBoxLayout(&dialog);
+
+	auto* queryLayout = new QHBoxLayout();
+	layout->addLayout(queryLayout);
+
+	auto* queryWidget = new QLineEdit(&dialog);
+	queryWidget->setPlaceholderText("Text to find in the build logs and saved logs");
+	queryLayout->addWidget(queryWidget);
+
+	auto* searchButton = new QPushButton("Search", &dialog);
+	queryLayout->addWidget(searchButton);
+
+	auto* resultsTree = new QTreeWidget(&dialog);
+	resultsTree->setColumnCount(4);
+	resultsTree->setHeaderLabels(QStringList() << "Log" << "Date" << "Line" << "Text");
+	resultsTree->setRootIsDecorated(false);
+	resultsTree->setUniformRowHeights(true);
+	resultsTree->header()->setSectionResizeMode(0, QHeaderView::ResizeToContents);
+	layout->addWidget(resultsTree);
+
+	auto* statusLabel = new QLabel(&dialog);
+	layout->addWidget(statusLabel);
+
+	auto indexStatus = [this]()
+	{
+		auto logCount = 0;
+		auto logSize = qint64{0};
+		mLogIndex.Stats(logCount, logSize);
+
+		auto status = QString("%1 logs (%2 MB) indexed").arg(logCount).arg(logSize / (1024.0 * 1024.0), 0, 'f', 1);
+		if (mLogIndexThread != nullptr)
+			status += ", more are being indexed";
+		return status;
+	};
+
+	statusLabel->setText(indexStatus());
+
+	const auto maxMatches = 1000;
+	auto search = [&]()
+	{
+		QApplication::setOverrideCursor(Qt::WaitCursor);
+
+		auto timer = QElapsedTimer{};
+		timer.start();
+		const auto matches = mLogIndex.Search(queryWidget->text(), maxMatches);
+		const auto elapsed = timer.elapsed();
+
+		resultsTree->clear();
+
+		auto items = QList<QTreeWidgetItem*>{};
+		for (const auto& match : matches)
+		{
+			auto* item = new QTreeWidgetItem(QStringList() << QFileInfo(match.FilePath).fileName() << match.Modified.toString("yyyy-MM-dd HH:mm")
+			                                               << QString::number(match.Line + 1) << match.Text);
+			item->setData(0, Qt::UserRole, match.FilePath);
+			item->setToolTip(0, QDir::toNativeSeparators(match.FilePath));
+			items.append(item);
+		}
+		resultsTree->addTopLevelItems(items);
+
+		QApplication::restoreOverrideCursor();
 
-	layout->addLayout(languageLayout);
+		statusLabel->setText(QString("%1 matching lines%2 in %3 ms, oldest first. %4")
+		                         .arg(matches.count())
+		                         .arg(matches.count() >= maxMatches ? QString(" (only the first %1 are shown)").arg(maxMatches) : QString())
+		                         .arg(elapsed)
+		                         .arg(indexStatus()));
+	};
+
+	connect(queryWidget, &QLineEdit::returnPressed, search);
+	connect(searchButton, &QPushButton::clicked, search);
+	connect(resultsTree, &QTreeWidget::itemActivated, [](QTreeWidgetItem* Item)
+	{
+		QDesktopServices::openUrl(QUrl::fromLocalFile(Item->data(0, Qt::UserRole).toString()));
+	});
 
 	auto* buttonBox = new QDialogButtonBox(&dialog);
 	buttonBox->setOrientation(Qt::Horizontal);
-	buttonBox->setStandardButtons(QDialogButtonBox::Ok | QDialogButtonBox::Cancel);
+	buttonBox->setStandardButtons(QDialogButtonBox::Close);
 	buttonBox->setCenterButtons(true);
 
 	layout->addWidget(buttonBox);
 
-	connect(buttonBox, SIGNAL(accepted()), &dialog, SLOT(accept()));
 	connect(buttonBox, SIGNAL(rejected()), &dialog, SLOT(reject()));
 
-	if (dialog.exec() != QDialog::Accepted)
+	dialog.exec();
+}
+
+// Only one update runs at a time, logs that are added meanwhile are picked up by another one right after it
+void mlMainWindow::UpdateLogIndex()
+{
+	if (mLogIndexThread != nullptr)
 	{
+		mLogIndexPending = true;
 		return;
 	}
 
-	mBuildLanguage = languageCombo->currentText();
-	mTreyarchTheme = checkBox->isChecked();
+	mLogIndexPending = false;
 
-	settings.setValue("BuildLanguage", mBuildLanguage);
-	settings.setValue("UseDarkTheme", mTreyarchTheme);
+	// The current session log is still growing, it's indexed once the next session started
+	const auto logsPath = LogsPath();
+	const auto excludedFiles = QStringList{mOutputSink.SpillFile()};
+	auto* logIndex = &mLogIndex;
 
-	UpdateTheme();
+	mLogIndexThread = new mlWorkThread([logIndex, logsPath, excludedFiles](mlWorkThread& Thread)
+	{
+		logIndex->Update(logsPath, excludedFiles, [&Thread]()
+		{
+			return Thread.IsCancelled();
+		});
+
+		return true;
+	});
+
+	connect(mLogIndexThread, SIGNAL(finished()), this, SLOT(OnLogIndexFinished()));
+	mTasks.Start(mLogIndexThread, "Index logs");
+}
+
+void mlMainWindow::OnLogIndexFinished()
+{
+	mLogIndexThread = nullptr;
+
+	if (mLogIndexPending)
+		mLogIndexTimer.start();
 }
 
 void mlMainWindow::UpdateTheme() const
@@ -1364,13 +2750,154 @@ void mlMainWindow::OnEditDvars()
 	}
 }
 
-void mlMainWindow::OnSaveLog() const
+// Each build and conversion gets its own log in logs/sessions that the output is written to while it runs, only the most
+// recent ones are kept
+void mlMainWindow::StartLogSession(const QString& Name)
+{
+	const auto maxSessionLogs = 100;
+	auto sessionDir = QDir{LogsPath() + "/sessions"};
+	if (!sessionDir.mkpath("."))
+		sessionDir.setPath(QStandardPaths::writableLocation(QStandardPaths::TempLocation));
+
+	const auto sessionLogs = sessionDir.entryInfoList(QStringList() << "*.txt", QDir::Files, QDir::Time);
+	for (auto logIdx = maxSessionLogs - 1; logIdx < sessionLogs.count(); logIdx++)
+		QFile::remove(sessionLogs[logIdx].filePath());
+
+	const auto time = QDateTime::currentDateTime().toString("yyyy-MM-dd_HH_mm_ss_zzz");
+	const auto sessionLog = sessionDir.absoluteFilePath(QString("%1_%2.txt").arg(Name, time));
+	mOutputSink.SetSpillFile(sessionLog);
+	mOutputWidget->Model()->SetFilePath(sessionLog);
+	UpdateLogCounts();
+}
+
+void mlMainWindow::UpdateOutput()
+{
+	mOutputSink.FlushSpillFile();
+	mOutputWidget->Model()->Refresh();
+	UpdateLogCounts();
+}
+
+void mlMainWindow::UpdateLogCounts() const
+{
+	const auto& parser = mOutputSink.Parser();
+
+	auto counts = QStringList{};
+	for (auto kind = 0; kind < ML_LOG_KIND_COUNT; kind++)
+	{
+		const auto count = parser.Count(static_cast<mlLogLineKind>(kind));
+		if (count > 0)
+			counts.append(QString("%1 %2%3").arg(count).arg(mlLogParser::KindName(static_cast<mlLogLineKind>(kind))).arg(count == 1 ? "" : "s"));
+	}
+
+	mLogCountsWidget->setText(counts.isEmpty() ? QString("No errors or warnings") : counts.join(", "));
+
+	const auto hasErrors = parser.NextError(-1) >= 0;
+	mPreviousErrorButton->setEnabled(hasErrors);
+	mNextErrorButton->setEnabled(hasErrors);
+}
+
+void mlMainWindow::OnPreviousError()
+{
+	ShowNextError(false);
+}
+
+void mlMainWindow::OnNextError()
+{
+	ShowNextError(true);
+}
+
+void mlMainWindow::ShowNextError(bool Forward)
+{
+	mOutputSink.Flush();
+	UpdateOutput();
+
+	// The console shows the session log, so its rows are the parser's line numbers
+	const auto& parser = mOutputSink.Parser();
+	const auto currentRow = mOutputWidget->CurrentRow();
+
+	auto entryIdx = -1;
+	if (Forward)
+		entryIdx = parser.NextError(currentRow);
+	else
+		entryIdx = parser.PreviousError(currentRow >= 0 ? currentRow : parser.LineCount());
+
+	if (entryIdx < 0)
+	{
+		QApplication::beep();
+		return;
+	}
+
+	mOutputWidget->ShowRow(static_cast<int>(parser.Entry(entryIdx).Line));
+	mOutputWidget->setFocus();
+}
+
+void mlMainWindow::OnFindNext()
+{
+	FindText(true);
+}
+
+void mlMainWindow::OnFindPrevious()
+{
+	FindText(false);
+}
+
+void mlMainWindow::FindText(bool Forward)
+{
+	const auto text = mFindWidget->text();
+	if (text.isEmpty())
+	{
+		mFindWidget->setFocus();
+		return;
+	}
+
+	UpdateOutput();
+
+	auto* model = mOutputWidget->Model();
+	const auto currentRow = mOutputWidget->CurrentRow();
+
+	auto startRow = 0;
+	if (Forward)
+		startRow = currentRow + 1;
+	else
+		startRow = currentRow >= 0 ? currentRow - 1 : model->rowCount() - 1;
+
+	// Searches the mapped log without reading it into memory, even so a long log takes a moment
+	QApplication::setOverrideCursor(Qt::WaitCursor);
+	auto row = -1;
+	if (startRow >= 0 && startRow < model->rowCount())
+		row = model->Find(text, startRow, Forward, Qt::CaseInsensitive);
+	QApplication::restoreOverrideCursor();
+
+	if (row < 0)
+	{
+		QApplication::beep();
+		return;
+	}
+
+	mOutputWidget->ShowRow(row);
+}
+
+void mlMainWindow::OnGoToLine()
+{
+	UpdateOutput();
+
+	const auto rowCount = mOutputWidget->Model()->rowCount();
+	if (rowCount == 0)
+		return;
+
+	auto ok = false;
+	const auto line = QInputDialog::getInt(this, "Go to Line", QString("Line (1 - %1):").arg(rowCount), mOutputWidget->CurrentRow() + 1, 1, rowCount, 1, &ok);
+	if (ok)
+		mOutputWidget->ShowRow(line - 1);
+}
+
+void mlMainWindow::OnSaveLog()
 {
 	// want to make a logs directory for easy management of launcher logs (exe_dir/logs)
-	const auto dir = QDir{};
-	if (!dir.exists("logs"))
+	const auto logsPath = LogsPath();
+	if (!QDir{}.exists(logsPath))
 	{
-		const auto result = dir.mkdir("logs");
+		const auto result = QDir{}.mkpath(logsPath);
 		if (!result)
 		{
 			QMessageBox::warning(nullptr, "Error", QString("Could not create the \"logs\" directory"));
@@ -1387,15 +2914,30 @@ void mlMainWindow::OnSaveLog() const
 	auto dateStr = ss.str();
 	std::replace(dateStr.begin(), dateStr.end(), ':', '_');
 
-	auto log = QFile{QString{"logs/modlog_%1.txt"}.arg(dateStr.c_str())};
+	const auto logPath = QString{"%1/modlog_%2.txt"}.arg(logsPath, dateStr.c_str());
+
+	// The session log already has everything, including what the console trimmed, so it only needs to be copied
+	const auto sessionLog = mOutputSink.SpillFile();
+	mOutputSink.FlushSpillFile();
+
+	if (sessionLog.isEmpty() || !QFileInfo::exists(sessionLog))
+	{
+		QMessageBox::information(nullptr, QString("Save Log"), QString("There is nothing in the console log to save yet"));
+		return;
+	}
 
-	if (!log.open(QIODevice::WriteOnly))
+	if (!QFile::copy(sessionLog, logPath))
+	{
+		QMessageBox::warning(nullptr, "Error", QString("Could not copy the console log to %1").arg(QDir::toNativeSeparators(logPath)));
 		return;
+	}
 
-	auto stream = QTextStream(&log);
-	stream << mOutputWidget->toPlainText();
+	QMessageBox::information(nullptr, QString("Save Log"), QString("The console log has been saved to %1").arg(QDir::toNativeSeparators(logPath)));
+}
 
-	QMessageBox::information(nullptr, QString("Save Log"), QString("The console log has been saved to %1").arg(log.fileName()));
+QString mlMainWindow::LogsPath()
+{
+	return QDir::cleanPath(QCoreApplication::applicationDirPath() + "/logs");
 }
 
 void mlMainWindow::UpdateWorkshopItem()
@@ -1630,36 +3172,32 @@ void mlMainWindow::OnRunMapOrMod()
 	}
 
 	auto* item = itemList[0];
-	auto args = QStringList{};
 
-	if (!mRunDvars.isEmpty())
-	{
-		args << mRunDvars;
-	}
+	// Running the game is a build with nothing but the run step, so it waits for the build that's in progress
+	auto job = mlBuildJob{};
+	job.Type = ML_JOB_BUILD;
+	job.IgnoreErrors = false;
+	job.ForceRebuild = false;
 
-	args << "+set" << "fs_game";
+	auto& options = job.Options;
+	options.GamePath = mGamePath;
+	options.ToolsPath = mToolsPath;
 
 	if (item->data(0, Qt::UserRole).toInt() == ML_ITEM_MAP)
 	{
-		const auto mapName = item->text(0);
-		args << mapName;
-		args << "+devmap" << mapName;
+		options.Maps.append(item->text(0));
 	}
 	else
 	{
 		const auto modName = item->parent() != nullptr ? item->parent()->text(0) : item->text(0);
-		args << modName;
+		options.ModZones.append(QPair<QString, QString>(modName, QString()));
 	}
 
-	const auto extraOptions = mRunOptionsWidget->text();
-	if (!extraOptions.isEmpty())
-	{
-		args << extraOptions.split(' ');
-	}
+	options.Run = true;
+	options.RunDvars = mRunDvars;
+	options.RunOptions = mRunOptionsWidget->text();
 
-	auto commands = QList<QPair<QString, QStringList>>{};
-	commands.append(QPair<QString, QStringList>(QString("%1BlackOps3.exe").arg(mGamePath), args));
-	StartBuildThread(commands);
+	EnqueueBuild(job);
 }
 
 void mlMainWindow::OnCleanXPaks()
@@ -1710,10 +3248,26 @@ void mlMainWindow::OnCleanXPaks()
 		return;
 	}
 
-	for (const auto& file : fileList)
+	auto* cleanThread = new mlWorkThread([fileList](mlWorkThread& Thread)
 	{
-		QFile(file).remove();
-	}
+		auto removed = 0;
+		for (const auto& file : fileList)
+		{
+			if (Thread.IsCancelled())
+				break;
+
+			if (QFile(file).remove())
+				removed++;
+
+			Thread.SetProgress(QString("%1/%2 files").arg(removed).arg(fileList.count()));
+		}
+
+		emit Thread.OutputReady(QString("Clean XPaks: Deleted %1 of %2 files").arg(removed).arg(fileList.count()));
+		return removed == fileList.count();
+	});
+
+	connect(cleanThread, SIGNAL(OutputReady(QString)), &mOutputSink, SLOT(Append(QString)), Qt::DirectConnection);
+	mTasks.Start(cleanThread, QString("Clean XPaks (%1)").arg(relativeFolder));
 }
 
 void mlMainWindow::OnDelete()
@@ -1745,8 +3299,29 @@ void mlMainWindow::OnDelete()
 		return;
 	}
 
-	QDir(folder).removeRecursively();
-	PopulateFileList();
+	// Large mods take a while to delete, the file list is refreshed once they're gone
+	auto* deleteThread = new mlWorkThread([folder](mlWorkThread& Thread)
+	{
+		auto removed = 0;
+		QDirIterator it(folder, QDir::Files | QDir::Hidden | QDir::System, QDirIterator::Subdirectories);
+		while (it.hasNext() && !Thread.IsCancelled())
+		{
+			QFile::remove(it.next());
+			Thread.SetProgress(QString("%1 files").arg(++removed));
+		}
+
+		if (Thread.IsCancelled() || !QDir(folder).removeRecursively())
+		{
+			emit Thread.OutputReady(QString("Delete: Could not delete everything in '%1'").arg(folder));
+			return false;
+		}
+
+		return true;
+	});
+
+	connect(deleteThread, SIGNAL(OutputReady(QString)), &mOutputSink, SLOT(Append(QString)), Qt::DirectConnection);
+	connect(deleteThread, &QThread::finished, this, &mlMainWindow::PopulateFileList);
+	mTasks.Start(deleteThread, QString("Delete '%1'").arg(QDir(mGamePath).relativeFilePath(folder)));
 }
 
 void mlMainWindow::OnExport2BinChooseDirectory() const
@@ -1765,16 +3340,295 @@ void mlMainWindow::OnExport2BinToggleOverwriteFiles() const
 	settings.setValue("Export2Bin_OverwriteFiles", mExport2BinOverwriteWidget->isChecked());
 }
 
-void mlMainWindow::BuildOutputReady(const QString& Output) const
+void mlMainWindow::OnExport2BinSetWorkers() const
+{
+	auto settings = QSettings{};
+	settings.setValue("Export2Bin_Workers", mExport2BinWorkersWidget->value());
+}
+
+void mlMainWindow::OnExport2BinToggleMirrorFolders() const
+{
+	auto settings = QSettings{};
+	settings.setValue("Export2Bin_MirrorFolders", mExport2BinMirrorFoldersWidget->isChecked());
+}
+
+void mlMainWindow::OnExport2BinPlanReady()
+{
+	auto* planThread = qobject_cast<mlConvertPlanThread*>(sender());
+	planThread->deleteLater();
+
+	const auto& plan = planThread->Plan();
+	mOutputSink.Append(plan.Summary());
+
+	if (plan.Files.isEmpty())
+		return;
+
+	// Dropping the same files again after a batch was cut short continues it, the journal of a running batch is still
+	// being written though
+	const auto lastBatch = mJournaledConvertThread == nullptr ? mlConvertJournal::Load() : mlConvertBatch{};
+	if (!lastBatch.Finished && lastBatch.Files == plan.Files && lastBatch.OutputDirs == plan.OutputDirs &&
+	    lastBatch.RemainingCount() < lastBatch.Files.count())
+	{
+		auto remaining = lastBatch.Remaining();
+		mOutputSink.Append(QString("Export2Bin: Continuing the last batch, %1 of %2 files were already converted")
+		                   .arg(lastBatch.Files.count() - remaining.Files.count()).arg(lastBatch.Files.count()));
+		StartConvertThread(remaining.Files, remaining.OutputDir, planThread->Overwrite(), remaining.OutputDirs);
+		return;
+	}
+
+	auto files = plan.Files;
+	auto outputDir = mExport2BinTargetDirWidget->text();
+	StartConvertThread(files, outputDir, planThread->Overwrite(), plan.OutputDirs);
+}
+
+void mlMainWindow::OnExport2BinUpdateProgress()
+{
+	if (mConvertThread == nullptr || mExport2BinGUIWidget == nullptr)
+	{
+		mExport2BinProgressTimer.stop();
+		return;
+	}
+
+	const auto stats = mConvertThread->ProgressCounters().Stats();
+	mExport2BinProgressWidget->setRange(0, qMax(stats.TotalFiles, 1));
+	mExport2BinProgressWidget->setValue(stats.DoneFiles);
+	mExport2BinStatsWidget->setText(stats.Text());
+}
+
+void mlMainWindow::OnExport2BinConvertFinished()
+{
+	if (sender() == mJournaledConvertThread)
+		mJournaledConvertThread = nullptr;
+
+	if (sender() != mConvertThread)
+		return;
+
+	// One more update so the numbers are final, the task manager deletes the thread after this
+	OnExport2BinUpdateProgress();
+	mExport2BinProgressTimer.stop();
+	mConvertThread = nullptr;
+}
+
+void mlMainWindow::OnExport2BinResumeBatch()
+{
+	if (mJournaledConvertThread != nullptr)
+	{
+		mOutputSink.Append("Export2Bin: The last batch is still running, it can be resumed once it stopped");
+		return;
+	}
+
+	const auto lastBatch = mlConvertJournal::Load();
+	if (lastBatch.Finished || lastBatch.RemainingCount() == 0)
+	{
+		mOutputSink.Append("Export2Bin: The last batch was completed, there is nothing to resume");
+		return;
+	}
+
+	auto remaining = lastBatch.Remaining();
+	if (mTasks.RunningCount() == 0)
+		StartLogSession("export2bin");
+	mOutputSink.Append(QString("Export2Bin: Resuming the last batch, %1 of %2 files are left")
+	                   .arg(remaining.Files.count()).arg(lastBatch.Files.count()));
+	StartConvertThread(remaining.Files, remaining.OutputDir, remaining.Overwrite, remaining.OutputDirs);
+}
+
+void mlMainWindow::OnExport2BinToggleWatch()
+{
+	const auto folder = mExport2BinWatchDirWidget->text();
+	auto settings = QSettings{};
+	settings.setValue("Export2Bin_WatchDir", folder);
+
+	if (!mExport2BinWatchWidget->isChecked())
+	{
+		mExportWatcher.Stop();
+		settings.setValue("Export2Bin_Watch", false);
+		return;
+	}
+
+	if (!mExportWatcher.Start(folder))
+	{
+		mExport2BinWatchWidget->setChecked(false);
+		QMessageBox::warning(mExport2BinGUIWidget, "Watch Folder", QString("Could not watch the folder '%1'.").arg(folder));
+		return;
+	}
+
+	settings.setValue("Export2Bin_Watch", true);
+	mOutputSink.Append(QString("Export2Bin: Watching '%1' for new and changed exports").arg(folder));
+}
+
+void mlMainWindow::OnExport2BinChooseWatchDirectory()
+{
+	const auto dir = QFileDialog::getExistingDirectory(mExport2BinGUIWidget, tr("Open Directory"), mExport2BinWatchDirWidget->text(),
+	                                                      QFileDialog::ShowDirsOnly | QFileDialog::DontResolveSymlinks);
+	if (dir.isEmpty())
+		return;
+
+	mExport2BinWatchDirWidget->setText(dir);
+	if (mExport2BinWatchWidget->isChecked())
+		OnExport2BinToggleWatch();
+}
+
+void mlMainWindow::OnExport2BinWatchFilesReady(const QStringList& Files)
+{
+	for (const auto& file : Files)
+	{
+		if (!mWatchPendingFiles.contains(file))
+			mWatchPendingFiles.append(file);
+	}
+
+	StartWatchConvertThread();
+}
+
+void mlMainWindow::OnExport2BinWatchConvertFinished()
+{
+	mWatchConvertThread = nullptr;
+
+	StartWatchConvertThread();
+}
+
+void mlMainWindow::StartWatchConvertThread()
 {
-	mOutputWidget->appendPlainText(Output);
+	// Files that change while a batch converts are picked up by the next one
+	if (mWatchConvertThread != nullptr || mWatchPendingFiles.isEmpty())
+		return;
+
+	// The dock's settings if it was opened, otherwise the ones it saved last time
+	const auto settings = QSettings{};
+	auto outputDir = mExport2BinGUIWidget != nullptr ? mExport2BinTargetDirWidget->text()
+		: settings.value("Export2Bin_TargetDir", QDir(QString("%1/model_export/export2bin/").arg(mToolsPath)).absolutePath()).toString();
+	const auto overwrite = mExport2BinGUIWidget != nullptr ? mExport2BinOverwriteWidget->isChecked()
+		: settings.value("Export2Bin_OverwriteFiles", true).toBool();
+	const auto workers = settings.value("Export2Bin_Workers", QThread::idealThreadCount()).toInt();
+
+	const auto description = QString("Export2Bin %1 watched files").arg(mWatchPendingFiles.count());
+	mWatchConvertThread = new mlConvertThread(mWatchPendingFiles, outputDir, true, overwrite, workers);
+	mWatchPendingFiles.clear();
+
+	connect(mWatchConvertThread, SIGNAL(OutputReady(QString)), &mOutputSink, SLOT(Append(QString)), Qt::DirectConnection);
+	connect(mWatchConvertThread, SIGNAL(finished()), this, SLOT(OnExport2BinWatchConvertFinished()));
+	mTasks.Start(mWatchConvertThread, description);
 }
 
 void mlMainWindow::BuildFinished()
 {
-	mBuildButton->setText("Build");
-	mBuildThread->deleteLater();
+	mCancelButton->setEnabled(false);
 	mBuildThread = nullptr;
+
+	mBuildQueue.Finish();
+	UpdateBuildQueue();
+	StartNextBuild(false);
+}
+
+void mlMainWindow::UpdateTaskList()
+{
+	if (!mTaskWidget->isVisible())
+	{
+		mTaskTimer.stop();
+		return;
+	}
+
+	const auto currentId = mTaskListWidget->currentItem() != nullptr ? mTaskListWidget->currentItem()->data(0, Qt::UserRole).toInt() : 0;
+	mTaskListWidget->clear();
+
+	for (const auto* task : mTasks.Tasks())
+	{
+		auto status = QString{};
+		switch (task->State)
+		{
+		case ML_TASK_RUNNING:
+			status = task->Thread->Progress();
+			if (status.isEmpty())
+				status = "Running";
+			break;
+
+		case ML_TASK_SUCCEEDED:
+			status = "Succeeded";
+			break;
+
+		case ML_TASK_FAILED:
+			status = "Failed";
+			break;
+
+		case ML_TASK_CANCELLED:
+			status = "Cancelled";
+			break;
+		}
+
+		const auto duration = task->State == ML_TASK_RUNNING ? task->Timer.elapsed() : task->Duration;
+		auto* item = new QTreeWidgetItem(mTaskListWidget, QStringList() << task->Description << status
+		                                 << QString("%1 s").arg(duration / 1000.0, 0, 'f', 1));
+		item->setData(0, Qt::UserRole, task->Id);
+
+		if (task->State == ML_TASK_RUNNING)
+		{
+			auto font = item->font(0);
+			font.setBold(true);
+			item->setFont(0, font);
+		}
+
+		if (task->Id == currentId)
+			mTaskListWidget->setCurrentItem(item);
+	}
+
+	if (mTasks.RunningCount() > 0)
+		mTaskTimer.start();
+	else
+		mTaskTimer.stop();
+}
+
+void mlMainWindow::OnTaskCancel()
+{
+	auto* item = mTaskListWidget->currentItem();
+	if (item != nullptr)
+		mTasks.Cancel(item->data(0, Qt::UserRole).toInt());
+}
+
+void mlMainWindow::OnBuildQueueMoveUp()
+{
+	const auto row = mBuildQueueListWidget->currentRow();
+	if (mBuildQueue.Move(row, row - 1))
+	{
+		UpdateBuildQueue();
+		mBuildQueueListWidget->setCurrentRow(row - 1);
+	}
+}
+
+void mlMainWindow::OnBuildQueueMoveDown()
+{
+	const auto row = mBuildQueueListWidget->currentRow();
+	if (mBuildQueue.Move(row, row + 1))
+	{
+		UpdateBuildQueue();
+		mBuildQueueListWidget->setCurrentRow(row + 1);
+	}
+}
+
+void mlMainWindow::OnBuildQueueRemove()
+{
+	const auto row = mBuildQueueListWidget->currentRow();
+	if (row == 0 && mBuildQueue.IsRunning())
+	{
+		OnCancelBuild();
+		return;
+	}
+
+	if (mBuildQueue.Remove(row))
+		UpdateBuildQueue();
+}
+
+void mlMainWindow::OnBuildQueueResume()
+{
+	const auto busy = mBuildThread != nullptr || !mBuildQueue.IsEmpty();
+	mBuildQueue.Resume();
+
+	UpdateBuildQueue();
+	StartNextBuild(!busy);
+}
+
+void mlMainWindow::OnBuildQueueDiscard()
+{
+	mBuildQueue.DiscardPaused();
+	UpdateBuildQueue();
 }
 
 Export2BinGroupBox::Export2BinGroupBox(QWidget* parent, mlMainWindow* parent_window) : QGroupBox(parent),
@@ -1799,22 +3653,8 @@ void Export2BinGroupBox::dropEvent(QDropEvent* event)
 
 	if (mimeData->hasUrls())
 	{
-		auto pathList = QStringList{};
-		auto urlList = mimeData->urls();
-
-		auto workingDir = QDir{parentWindow->mToolsPath};
-		for (const auto& i : urlList)
-		{
-			pathList.append(i.toLocalFile());
-		}
-
-		auto* process = new QProcess();
-		connect(process, SIGNAL(finished(int)), process, SLOT(deleteLater()));
-
-		const auto allowOverwrite = this->parentWindow->mExport2BinOverwriteWidget->isChecked();
-
-		auto outputDir = parentWindow->mExport2BinTargetDirWidget->text();
-		parentWindow->StartConvertThread(pathList, outputDir, allowOverwrite);
+		// Dropped folders are listed off the GUI thread, the conversion starts once that's done
+		parentWindow->PlanConvert(mimeData->urls());
 
 		event->acceptProposedAction();
 	}
@@ -18,61 +18,112 @@
 
 #pragma once
 
-class mlBuildThread : public QThread
+class mlBuildThread : public mlTaskThread
 {
 	Q_OBJECT
 
 public:
-	mlBuildThread(QList<QPair<QString, QStringList>> Commands, bool IgnoreErrors);
-	void run();
-	bool Succeeded() const
-	{
-		return mSuccess;
-	}
+	mlBuildThread(mlBuildGraph Graph, int MaxJobs, const mlResourceLimits& Limits, bool IgnoreErrors, bool ForceRebuild);
+	void run() override;
 
-	void Cancel()
+	void Cancel() override
 	{
-		mCancel = true;
+		if (!mCancel.exchange(true))
+		{
+			mCancelTime = QDeadlineTimer::current().deadline();
+			emit CancelRequested();
+		}
 	}
 
-signals:
-	void OutputReady(const QString& Output);
+	QString Progress() override;
 
 protected:
-	QList<QPair<QString, QStringList>> mCommands;
-	bool mSuccess;
-	bool mCancel;
+	mlBuildGraph mGraph;
+	int mMaxJobs;
+	mlResourceLimits mLimits;
+	std::atomic<qint64> mCancelTime;
+	std::atomic<int> mStepsDone;
 	bool mIgnoreErrors;
+	bool mForceRebuild;
 };
 
-class mlConvertThread : public QThread
+class mlConvertThread : public mlTaskThread
 {
 	Q_OBJECT
 
 public:
-	mlConvertThread(QStringList& Files, QString& OutputDir, bool IgnoreErrors, bool mOverwrite);
+	mlConvertThread(QStringList& Files, QString& OutputDir, bool IgnoreErrors, bool mOverwrite, int MaxWorkers,
+	                const QStringList& OutputDirs = QStringList());
 	void run() override;
-	bool Succeeded() const
+	QString Progress() override;
+
+	static QString DefaultConverterPath();
+
+	// Runs another converter instead of export2bin, it gets the same arguments after its own and has to work the same
+	// way: the export comes in on stdin and the result goes to stdout
+	void SetConverter(const QString& Program, const QStringList& Arguments);
+
+	// Without the cache every file is converted again, which is what benchmarks want
+	void SetUseCache(bool UseCache)
 	{
-		return mSuccess;
+		mUseCache = UseCache;
 	}
 
-	void Cancel()
+	// Safe to read from any thread while the conversion runs
+	mlConvertProgress& ProgressCounters()
 	{
-		mCancel = true;
+		return mProgress;
 	}
 
-signals:
-	void OutputReady(const QString& Output);
+	// Journaled batches replace the last batch the user can resume. There is a single journal, so only one batch at a
+	// time may be journaled.
+	void SetJournaled(bool Journaled)
+	{
+		mJournaled = Journaled;
+	}
 
 protected:
 	QStringList mFiles;
 	QString mOutputDir;
+	QStringList mOutputDirs; // Overrides mOutputDir for each file when it isn't empty
 	bool mOverwrite;
-
-	bool mSuccess;
-	bool mCancel;
+	int mMaxWorkers;
 	bool mIgnoreErrors;
+
+	QString mConverterPath;
+	QStringList mConverterArguments;
+	bool mUseCache;
+	bool mJournaled;
+
+	mlConvertProgress mProgress;
+};
+
+// Walks the folders dropped on the Export2Bin dock, big export trees take a while to list
+class mlConvertPlanThread : public QThread
+{
+	Q_OBJECT
+
+public:
+	mlConvertPlanThread(const QList<QUrl>& Urls, const QString& OutputDir, bool MirrorFolders, bool Overwrite);
+	void run() override;
+
+	const mlConvertPlan& Plan() const
+	{
+		return mPlan;
+	}
+
+	bool Overwrite() const
+	{
+		return mOverwrite;
+	}
+
+protected:
+	QList<QUrl> mUrls;
+	QString mOutputDir;
+	bool mMirrorFolders;
+	bool mOverwrite;
+
+	mlConvertPlan mPlan;
 };
 
 
@@ -95,6 +146,9 @@ public:
 
 	void UpdateDB();
 
+	// The logs folder next to the launcher, saved logs go right into it and session logs into its sessions folder
+	static QString LogsPath();
+
 	void OnCreateItemResult(CreateItemResult_t* CreateItemResult, bool IOFailure);
 	CCallResult<mlMainWindow, CreateItemResult_t> mSteamCallResultCreateItem;
 
@@ -110,10 +164,13 @@ protected slots:
 	void OnFileLevelEditor();
 	void OnFileExport2Bin();
 	void OnEditBuild();
+	void OnCancelBuild();
 	void OnEditPublish();
 	void OnEditOptions();
+	void OnEditBuildHistory();
+	void OnSearchLogs();
 	void OnEditDvars();
-	void OnSaveLog() const;
+	void OnSaveLog();
 	void OnHelpAbout();
 	void OnOpenZoneFile();
 	void OnOpenModRootFolder();
@@ -122,16 +179,48 @@ protected slots:
 	void OnDelete();
 	void OnExport2BinChooseDirectory() const;
 	void OnExport2BinToggleOverwriteFiles() const;
-	void BuildOutputReady(const QString& Output) const;
+	void OnExport2BinSetWorkers() const;
+	void OnExport2BinToggleWatch();
+	void OnExport2BinChooseWatchDirectory();
+	void OnExport2BinWatchFilesReady(const QStringList& Files);
+	void OnExport2BinWatchConvertFinished();
+	void OnExport2BinToggleMirrorFolders() const;
+	void OnExport2BinPlanReady();
+	void OnExport2BinResumeBatch();
+	void OnExport2BinUpdateProgress();
+	void OnExport2BinConvertFinished();
 	void BuildFinished();
+	void OnBuildQueueMoveUp();
+	void OnBuildQueueMoveDown();
+	void OnBuildQueueRemove();
+	void OnBuildQueueResume();
+	void OnBuildQueueDiscard();
+	void OnTaskCancel();
+	void UpdateOutput();
+	void UpdateLogCounts() const;
+	void OnPreviousError();
+	void OnNextError();
+	void OnFindNext();
+	void OnFindPrevious();
+	void OnGoToLine();
+	void UpdateLogIndex();
+	void OnLogIndexFinished();
+	void UpdateTaskList();
 	void ContextMenuRequested() const;
 	static void SteamUpdate();
 
 protected:
 	void closeEvent(QCloseEvent* Event) override;
 
-	void StartBuildThread(const QList<QPair<QString, QStringList>>& Commands);
-	void StartConvertThread(QStringList& pathList, QString& outputDir, bool allowOverwrite);
+	void EnqueueBuild(const mlBuildJob& Job);
+	void StartNextBuild(bool ClearOutput);
+	void UpdateBuildQueue() const;
+	void StartBuildThread(const mlBuildGraph& Graph, bool IgnoreErrors, bool ForceRebuild, const QString& Description);
+	void StartConvertThread(QStringList& pathList, QString& outputDir, bool allowOverwrite, const QStringList& outputDirs);
+	void PlanConvert(const QList<QUrl>& Urls);
+	void StartLogSession(const QString& Name);
+	void ShowNextError(bool Forward);
+	void FindText(bool Forward);
 
 	void PopulateFileList() const;
 	void UpdateWorkshopItem();
@@ -143,6 +232,9 @@ protected:
 	void CreateToolBar();
 
 	void InitExport2BinGUI();
+	void InitBuildQueueGUI();
+	void InitTaskGUI();
+	void StartWatchConvertThread();
 
 	QAction* mActionFileNew;
 	QAction* mActionFileAssetEditor;
@@ -151,15 +243,29 @@ protected:
 	QAction* mActionFileExit;
 	QAction* mActionEditBuild;
 	QAction* mActionEditPublish;
+	QAction* mActionEditBuildHistory;
+	QAction* mActionEditSearchLogs;
 	QAction* mActionEditOptions;
 	QAction* mActionHelpAbout;
 
 	QTreeWidget* mFileListWidget;
-	QPlainTextEdit* mOutputWidget;
+	mlLogView* mOutputWidget;
+	mlOutputSink mOutputSink;
+
+	mlLogIndex mLogIndex;
+	mlWorkThread* mLogIndexThread;
+	bool mLogIndexPending;
+	QTimer mLogIndexTimer;
+	QFileSystemWatcher mLogsWatcher;
 
 	QPushButton* mBuildButton;
+	QPushButton* mCancelButton;
 	QPushButton* mDvarsButton;
 	QPushButton* mLogButton;
+	QLabel* mLogCountsWidget;
+	QLineEdit* mFindWidget;
+	QPushButton* mPreviousErrorButton;
+	QPushButton* mNextErrorButton;
 	QCheckBox* mCompileEnabledWidget;
 	QComboBox* mCompileModeWidget;
 	QCheckBox* mLightEnabledWidget;
@@ -168,16 +274,43 @@ protected:
 	QCheckBox* mRunEnabledWidget;
 	QLineEdit* mRunOptionsWidget;
 	QCheckBox* mIgnoreErrorsWidget;
+	QCheckBox* mForceRebuildWidget;
 
 	mlBuildThread* mBuildThread;
+	mlBuildQueue mBuildQueue;
 	mlConvertThread* mConvertThread;
+	mlConvertThread* mJournaledConvertThread; // The batch writing the journal, at most one at a time
 
 	QDockWidget* mExport2BinGUIWidget;
 	QCheckBox* mExport2BinOverwriteWidget;
 	QLineEdit* mExport2BinTargetDirWidget;
+	QSpinBox* mExport2BinWorkersWidget;
+	QCheckBox* mExport2BinMirrorFoldersWidget;
+	QPushButton* mExport2BinResumeWidget;
+	QProgressBar* mExport2BinProgressWidget;
+	QLabel* mExport2BinStatsWidget;
+	QTimer mExport2BinProgressTimer;
+	QCheckBox* mExport2BinWatchWidget;
+	QLineEdit* mExport2BinWatchDirWidget;
+
+	mlExportWatcher mExportWatcher;
+	mlConvertThread* mWatchConvertThread;
+	QStringList mWatchPendingFiles;
+
+	QDockWidget* mBuildQueueWidget;
+	QListWidget* mBuildQueueListWidget;
+	QWidget* mBuildQueuePausedWidget;
+
+	mlTaskManager mTasks;
+	QDockWidget* mTaskWidget;
+	QTreeWidget* mTaskListWidget;
+	QTimer mTaskTimer;
 
 	bool mTreyarchTheme;
 	QString mBuildLanguage;
+	int mBuildJobs;
+	int mLinkShards;
+	int mLinkShardJobs;
 
 	QStringList mShippedMapList;
 	QTimer mTimer;
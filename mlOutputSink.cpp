@@ -0,0 +1,167 @@
+#include "stdafx.h"
+
+mlOutputSink::mlOutputSink(QObject* Parent)
+	: QObject(Parent), mPendingLines(0), mDroppedLines(0), mTotalLines(0), mTotalDroppedLines(0), mMaxLines(ML_DEFAULT_MAX_LINES),
+	  mFlushScheduled(false), mSpillFailed(false)
+{
+	mFlushTimer.setSingleShot(true);
+	connect(&mFlushTimer, SIGNAL(timeout()), this, SLOT(Flush()));
+	mSpillFlushTimer.setSingleShot(true);
+	connect(&mSpillFlushTimer, SIGNAL(timeout()), this, SLOT(OnSpillFlushTimer()));
+	mLastFlush.start();
+}
+
+mlOutputSink::~mlOutputSink()
+{
+	const QMutexLocker lock(&mMutex);
+	mSpillFile.close();
+}
+
+void mlOutputSink::SetMaxLines(int MaxLines)
+{
+	const QMutexLocker lock(&mMutex);
+	mMaxLines = qMax(MaxLines, 1);
+}
+
+int mlOutputSink::MaxLines() const
+{
+	const QMutexLocker lock(&mMutex);
+	return mMaxLines;
+}
+
+void mlOutputSink::SetSpillFile(const QString& FilePath)
+{
+	const QMutexLocker lock(&mMutex);
+	mSpillFile.close();
+	mSpillFile.setFileName(FilePath);
+	mSpillFailed = false;
+	mParser.Reset();
+}
+
+QString mlOutputSink::SpillFile() const
+{
+	const QMutexLocker lock(&mMutex);
+	return mSpillFile.fileName();
+}
+
+void mlOutputSink::FlushSpillFile()
+{
+	const QMutexLocker lock(&mMutex);
+	if (mSpillFile.isOpen())
+		mSpillFile.flush();
+}
+
+qint64 mlOutputSink::LineCount() const
+{
+	const QMutexLocker lock(&mMutex);
+	return mTotalLines;
+}
+
+qint64 mlOutputSink::DroppedLineCount() const
+{
+	const QMutexLocker lock(&mMutex);
+	return mTotalDroppedLines;
+}
+
+void mlOutputSink::Append(const QString& Text)
+{
+	// A text that already ends its last line doesn't get a second line break
+	const auto text = Text.endsWith('\n') ? Text.left(Text.size() - 1) : Text;
+	const auto lineCount = text.count('\n') + 1;
+
+	auto utf8 = text.toUtf8();
+	utf8.append('\n');
+
+	const QMutexLocker lock(&mMutex);
+
+	if (!mSpillFile.isOpen() && !mSpillFile.fileName().isEmpty() && !mSpillFailed)
+	{
+		QDir{}.mkpath(QFileInfo(mSpillFile.fileName()).absolutePath());
+		mSpillFailed = !mSpillFile.open(QIODevice::WriteOnly | QIODevice::Truncate);
+	}
+
+	if (mSpillFile.isOpen())
+		mSpillFile.write(utf8);
+	mParser.Parse(utf8.constData(), utf8.size());
+
+	mPending.append(text);
+	mPendingLines += lineCount;
+	mTotalLines += lineCount;
+
+	// A single text longer than the limit is still shown whole, the widget trims it
+	while (mPendingLines > mMaxLines && mPending.count() > 1)
+	{
+		const auto droppedLines = mPending.first().count('\n') + 1;
+		mPending.removeFirst();
+		mPendingLines -= droppedLines;
+		mDroppedLines += droppedLines;
+		mTotalDroppedLines += droppedLines;
+	}
+
+	// One queued call per frame at most, however many threads append how often
+	if (!mFlushScheduled)
+	{
+		mFlushScheduled = true;
+		QMetaObject::invokeMethod(this, "StartFlushTimer", Qt::QueuedConnection);
+	}
+}
+
+void mlOutputSink::StartFlushTimer()
+{
+	if (!mFlushTimer.isActive())
+		mFlushTimer.start(static_cast<int>(qMax<qint64>(0, ML_FRAME_TIME - mLastFlush.elapsed())));
+}
+
+void mlOutputSink::Flush()
+{
+	auto pending = QStringList{};
+	auto droppedLines = qint64{0};
+	auto spillFile = QString{};
+
+	{
+		const QMutexLocker lock(&mMutex);
+		pending.swap(mPending);
+		droppedLines = mDroppedLines;
+		mPendingLines = 0;
+		mDroppedLines = 0;
+		mFlushScheduled = false;
+
+		if (mSpillFile.isOpen())
+			spillFile = mSpillFile.fileName();
+	}
+
+	mFlushTimer.stop();
+	mLastFlush.start();
+
+	// Whatever this flush wrote reaches the disk within a second, without a flush for every frame
+	if (!mSpillFlushTimer.isActive())
+		mSpillFlushTimer.start(ML_SPILL_FLUSH_TIME);
+
+	if (droppedLines > 0)
+	{
+		if (spillFile.isEmpty())
+			pending.prepend(QString("... %1 lines not shown ...").arg(droppedLines));
+		else
+			pending.prepend(QString("... %1 lines not shown, the full output is in '%2' ...").arg(droppedLines).arg(QDir::toNativeSeparators(spillFile)));
+	}
+
+	if (!pending.isEmpty())
+		emit TextReady(pending.join('\n'));
+}
+
+void mlOutputSink::OnSpillFlushTimer()
+{
+	FlushSpillFile();
+}
+
+void mlOutputSink::Clear()
+{
+	{
+		const QMutexLocker lock(&mMutex);
+		mPending.clear();
+		mPendingLines = 0;
+		mDroppedLines = 0;
+	}
+
+	emit Cleared();
+}
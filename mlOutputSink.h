@@ -0,0 +1,81 @@
+#pragma once
+
+// Collects output from any number of threads and hands it to the GUI in one batch per frame, so a tool printing
+// thousands of lines a second costs a few appends a second instead of a queued signal for every chunk. When the GUI
+// falls behind only the most recent lines are kept, the spill file gets all of them. The spill file is written through
+// a buffer and flushed about once a second, so it's never more than a second behind the GUI.
+class mlOutputSink : public QObject
+{
+	Q_OBJECT
+
+public:
+	explicit mlOutputSink(QObject* Parent = nullptr);
+	~mlOutputSink() override;
+
+	// Lines kept waiting for the GUI, the widget showing them shouldn't keep more than this either
+	void SetMaxLines(int MaxLines);
+	int MaxLines() const;
+
+	// Everything appended from now on is also written to the file, an empty path stops spilling. The file is only
+	// created once there's something to write.
+	void SetSpillFile(const QString& FilePath);
+	QString SpillFile() const;
+
+	// Writes out what's buffered for the spill file, for reading it while the sink still appends to it
+	void FlushSpillFile();
+
+	// Everything appended since the spill file was last set, parsed on the appending threads. Its offsets are the ones
+	// in the spill file.
+	const mlLogParser& Parser() const
+	{
+		return mParser;
+	}
+
+	qint64 LineCount() const;        // Lines appended since the sink was created
+	qint64 DroppedLineCount() const; // Lines the GUI never got because it fell too far behind
+
+public slots:
+	// Can be called from any thread. Connect producers with Qt::DirectConnection so their text skips the event queue.
+	// The text is taken as whole lines, with or without a line break at its end.
+	void Append(const QString& Text);
+
+	// Hands whatever is pending to the GUI right away, only from the sink's own thread
+	void Flush();
+
+	// Drops what the GUI hasn't got yet and asks it to clear, the spill file keeps everything
+	void Clear();
+
+signals:
+	// Each appended text starts a new line, the same as QPlainTextEdit::appendPlainText
+	void TextReady(const QString& Text);
+	void Cleared();
+
+protected slots:
+	void StartFlushTimer();
+	void OnSpillFlushTimer();
+
+protected:
+	enum
+	{
+		ML_FRAME_TIME = 33,
+		ML_SPILL_FLUSH_TIME = 1000,
+		ML_DEFAULT_MAX_LINES = 10000
+	};
+
+	mutable QMutex mMutex;
+	QStringList mPending;
+	int mPendingLines;
+	qint64 mDroppedLines; // Since the last flush
+	qint64 mTotalLines;
+	qint64 mTotalDroppedLines;
+	int mMaxLines;
+	bool mFlushScheduled;
+	QFile mSpillFile;
+	bool mSpillFailed; // Couldn't create the spill file, don't try again for every line
+	mlLogParser mParser;
+
+	// Only touched from the sink's thread
+	QTimer mFlushTimer;
+	QTimer mSpillFlushTimer;
+	QElapsedTimer mLastFlush;
+};
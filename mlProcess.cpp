@@ -0,0 +1,129 @@
+#include "stdafx.h"
+
+#ifdef Q_OS_WIN
+#include <Windows.h>
+#else
+#include <csignal>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+mlProcess::mlProcess(QObject* Parent) : QProcess(Parent), mLowPriority(false)
+{
+#ifdef Q_OS_WIN
+	mJob = CreateJobObject(nullptr, nullptr);
+
+	// The child starts suspended and is only resumed once it's in the job, so nothing it starts can escape the job
+	setCreateProcessArgumentsModifier([this](QProcess::CreateProcessArguments* Arguments)
+	{
+		if (mJob != nullptr)
+			Arguments->flags |= CREATE_SUSPENDED;
+
+		if (mLowPriority)
+			Arguments->flags |= BELOW_NORMAL_PRIORITY_CLASS;
+	});
+
+	connect(this, &QProcess::started, [this]()
+	{
+QT_WARNING_PUSH
+QT_WARNING_DISABLE_DEPRECATED
+		const auto* processInformation = pid();
+QT_WARNING_POP
+
+		if (mJob != nullptr && processInformation != nullptr)
+		{
+			AssignProcessToJobObject(mJob, processInformation->hProcess);
+			ResumeThread(processInformation->hThread);
+		}
+	});
+#else
+	mProcessGroup = 0;
+
+	// Remembered so processes left behind by the child can still be killed after it exited
+	connect(this, &QProcess::started, [this]()
+	{
+		mProcessGroup = processId();
+	});
+#endif
+}
+
+mlProcess::~mlProcess()
+{
+#ifdef Q_OS_WIN
+	if (mJob != nullptr)
+		CloseHandle(mJob);
+#endif
+}
+
+#ifndef Q_OS_WIN
+void mlProcess::setupChildProcess()
+{
+	// Runs in the child right before exec, the child leads a new group that all of its own children join
+	setpgid(0, 0);
+
+	// Both are inherited by everything the child starts
+	if (mLowPriority)
+	{
+		setpriority(PRIO_PROCESS, 0, 10);
+#ifdef SYS_ioprio_set
+		const auto ioprioWhoProcess = 1;
+		const auto ioprioBestEffortLowest = (2 << 13) | 7;
+		syscall(SYS_ioprio_set, ioprioWhoProcess, 0, ioprioBestEffortLowest);
+#endif
+	}
+}
+#endif
+
+void mlProcess::KillTree()
+{
+#ifdef Q_OS_WIN
+	if (mJob != nullptr && TerminateJobObject(mJob, 1))
+		return;
+#else
+	if (mProcessGroup > 0 && ::kill(-static_cast<pid_t>(mProcessGroup), SIGKILL) == 0)
+		return;
+#endif
+
+	kill();
+}
+
+qint64 mlProcess::PeakMemory() const
+{
+#ifdef Q_OS_WIN
+	auto limits = JOBOBJECT_EXTENDED_LIMIT_INFORMATION{};
+	if (mJob != nullptr && QueryInformationJobObject(mJob, JobObjectExtendedLimitInformation, &limits, sizeof(limits), nullptr))
+		return static_cast<qint64>(limits.PeakJobMemoryUsed);
+#endif
+
+	return -1;
+}
+
+qint64 mlProcess::CpuTime() const
+{
+#ifdef Q_OS_WIN
+	auto accounting = JOBOBJECT_BASIC_ACCOUNTING_INFORMATION{};
+	if (mJob != nullptr && QueryInformationJobObject(mJob, JobObjectBasicAccountingInformation, &accounting, sizeof(accounting), nullptr))
+		return (accounting.TotalUserTime.QuadPart + accounting.TotalKernelTime.QuadPart) / 10000; // 100 ns units
+#endif
+
+	return -1;
+}
+
+void mlProcess::SetLowPriority(bool LowPriority)
+{
+	mLowPriority = LowPriority;
+
+#ifdef Q_OS_WIN
+	// The creation flag only covers the child, the job limit also covers everything the child starts
+	auto limits = JOBOBJECT_BASIC_LIMIT_INFORMATION{};
+	if (LowPriority)
+	{
+		limits.LimitFlags = JOB_OBJECT_LIMIT_PRIORITY_CLASS;
+		limits.PriorityClass = BELOW_NORMAL_PRIORITY_CLASS;
+	}
+
+	if (mJob != nullptr)
+		SetInformationJobObject(mJob, JobObjectBasicLimitInformation, &limits, sizeof(limits));
+#endif
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+// QProcess that owns the whole tree of processes started by the child (a job object on Windows, a process group
+// everywhere else) so it can be killed as a unit, and keeps track of the resources used by the tree
+class mlProcess : public QProcess
+{
+public:
+	explicit mlProcess(QObject* Parent = nullptr);
+	~mlProcess() override;
+
+	// Kills the child and every process it started, including the ones still running after the child exited
+	void KillTree();
+
+	// Peak memory used by the process tree in bytes, -1 if it isn't available on this platform
+	qint64 PeakMemory() const;
+
+	// User and kernel time used by the process tree in milliseconds, -1 if it isn't available on this platform
+	qint64 CpuTime() const;
+
+	// Runs the tree below normal priority so the editor and the game stay responsive, has to be set before starting
+	void SetLowPriority(bool LowPriority);
+
+protected:
+	bool mLowPriority;
+
+#ifdef Q_OS_WIN
+	void* mJob;
+#else
+	void setupChildProcess() override;
+
+	qint64 mProcessGroup;
+#endif
+};
@@ -0,0 +1,145 @@
+#include "stdafx.h"
+
+mlTaskThread::mlTaskThread()
+	: mSuccess(false), mCancel(false)
+{
+}
+
+mlWorkThread::mlWorkThread(std::function<bool(mlWorkThread&)> Work)
+	: mWork(std::move(Work))
+{
+}
+
+void mlWorkThread::run()
+{
+	mSuccess = mWork(*this) && !mCancel;
+}
+
+QString mlWorkThread::Progress()
+{
+	const QMutexLocker lock(&mProgressMutex);
+	return mProgress;
+}
+
+void mlWorkThread::SetProgress(const QString& Progress)
+{
+	const QMutexLocker lock(&mProgressMutex);
+	mProgress = Progress;
+}
+
+mlTaskManager::mlTaskManager(QObject* Parent)
+	: QObject(Parent), mNextId(1)
+{
+}
+
+mlTaskManager::~mlTaskManager()
+{
+	CancelAll();
+}
+
+int mlTaskManager::Start(mlTaskThread* Thread, const QString& Description)
+{
+	auto task = mlTaskInfo{};
+	task.Id = mNextId++;
+	task.Description = Description;
+	task.Thread = Thread;
+	task.State = ML_TASK_RUNNING;
+	task.Timer.start();
+	task.Duration = 0;
+	mTasks.append(task);
+
+	Thread->setParent(this);
+	connect(Thread, SIGNAL(finished()), this, SLOT(OnThreadFinished()));
+	Thread->start();
+
+	emit TaskStarted(task.Id);
+	return task.Id;
+}
+
+void mlTaskManager::Cancel(int TaskId)
+{
+	for (const auto& task : mTasks)
+	{
+		if (task.Id == TaskId && task.Thread != nullptr)
+			task.Thread->Cancel();
+	}
+}
+
+void mlTaskManager::CancelAll()
+{
+	for (const auto& task : mTasks)
+	{
+		if (task.Thread != nullptr)
+			task.Thread->Cancel();
+	}
+
+	for (const auto& task : mTasks)
+	{
+		if (task.Thread != nullptr)
+			task.Thread->wait();
+	}
+}
+
+QList<const mlTaskInfo*> mlTaskManager::Tasks() const
+{
+	auto tasks = QList<const mlTaskInfo*>{};
+	for (const auto& task : mTasks)
+	{
+		if (task.State == ML_TASK_RUNNING)
+			tasks.append(&task);
+	}
+
+	for (auto taskIdx = mTasks.count() - 1; taskIdx >= 0; taskIdx--)
+	{
+		if (mTasks[taskIdx].State != ML_TASK_RUNNING)
+			tasks.append(&mTasks[taskIdx]);
+	}
+
+	return tasks;
+}
+
+int mlTaskManager::RunningCount() const
+{
+	auto count = 0;
+	for (const auto& task : mTasks)
+	{
+		if (task.State == ML_TASK_RUNNING)
+			count++;
+	}
+
+	return count;
+}
+
+void mlTaskManager::OnThreadFinished()
+{
+	auto* thread = qobject_cast<mlTaskThread*>(sender());
+
+	for (auto taskIdx = 0; taskIdx < mTasks.count(); taskIdx++)
+	{
+		auto& task = mTasks[taskIdx];
+		if (task.Thread != thread)
+			continue;
+
+		task.State = thread->Succeeded() ? ML_TASK_SUCCEEDED : thread->IsCancelled() ? ML_TASK_CANCELLED : ML_TASK_FAILED;
+		task.Duration = task.Timer.elapsed();
+		task.Thread = nullptr;
+
+		// Other slots connected to finished() may still run after this one, so the thread is only deleted later
+		thread->deleteLater();
+
+		emit TaskFinished(task.Id);
+		break;
+	}
+
+	auto finishedCount = mTasks.count() - RunningCount();
+	for (auto taskIdx = 0; taskIdx < mTasks.count() && finishedCount > ML_MAX_FINISHED_TASKS;)
+	{
+		if (mTasks[taskIdx].State != ML_TASK_RUNNING)
+		{
+			mTasks.removeAt(taskIdx);
+			finishedCount--;
+		}
+		else
+			taskIdx++;
+	}
+}
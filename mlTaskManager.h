@@ -0,0 +1,117 @@
+#pragma once
+
+// Everything that runs in the background is one of these, so the task manager can show, cancel and clean up builds,
+// conversions and maintenance work the same way
+class mlTaskThread : public QThread
+{
+	Q_OBJECT
+
+public:
+	mlTaskThread();
+
+	bool Succeeded() const
+	{
+		return mSuccess;
+	}
+
+	bool IsCancelled() const
+	{
+		return mCancel;
+	}
+
+	// Can be called from any thread, the worker is woken up through the queued CancelRequested signal
+	virtual void Cancel()
+	{
+		if (!mCancel.exchange(true))
+			emit CancelRequested();
+	}
+
+	// A short line for the task panel, called from the GUI thread while the task runs
+	virtual QString Progress()
+	{
+		return QString();
+	}
+
+signals:
+	void OutputReady(const QString& Output);
+	void CancelRequested();
+
+protected:
+	bool mSuccess;
+	std::atomic<bool> mCancel;
+};
+
+// Runs a function as a task, for work that doesn't need a class of its own. The function returns whether it succeeded
+// and should check IsCancelled() every so often.
+class mlWorkThread : public mlTaskThread
+{
+public:
+	explicit mlWorkThread(std::function<bool(mlWorkThread&)> Work);
+	void run() override;
+
+	QString Progress() override;
+	void SetProgress(const QString& Progress);
+
+protected:
+	std::function<bool(mlWorkThread&)> mWork;
+
+	QMutex mProgressMutex;
+	QString mProgress;
+};
+
+enum mlTaskState
+{
+	ML_TASK_RUNNING,
+	ML_TASK_SUCCEEDED,
+	ML_TASK_FAILED,
+	ML_TASK_CANCELLED
+};
+
+struct mlTaskInfo
+{
+	int Id;
+	QString Description;
+	mlTaskThread* Thread; // Null once the task finished
+	mlTaskState State;
+	QElapsedTimer Timer;
+	qint64 Duration; // Milliseconds, only set once the task finished
+};
+
+// Owns every background task. Each task has its own lifetime, any number of them can run at the same time, and a
+// finished task's thread is deleted once whoever waits for it had a chance to look at it.
+class mlTaskManager : public QObject
+{
+	Q_OBJECT
+
+public:
+	explicit mlTaskManager(QObject* Parent = nullptr);
+	~mlTaskManager() override;
+
+	// Takes ownership of the thread and starts it
+	int Start(mlTaskThread* Thread, const QString& Description);
+
+	void Cancel(int TaskId);
+
+	// Cancels every task and waits for them to stop, for shutting down
+	void CancelAll();
+
+	// Running tasks first, then the most recently finished ones
+	QList<const mlTaskInfo*> Tasks() const;
+	int RunningCount() const;
+
+signals:
+	void TaskStarted(int TaskId);
+	void TaskFinished(int TaskId);
+
+protected slots:
+	void OnThreadFinished();
+
+protected:
+	enum
+	{
+		ML_MAX_FINISHED_TASKS = 20
+	};
+
+	int mNextId;
+	QList<mlTaskInfo> mTasks;
+};
@@ -19,8 +19,26 @@
 #pragma once
 
 #include <QtWidgets/QtWidgets>
+#include <atomic>
 #include "steam_api.h"
 #include "dvar.h"
+#include "mlBuildCache.h"
+#include "mlBuildGraph.h"
+#include "mlBuildHistory.h"
+#include "mlBuildQueue.h"
+#include "mlConvertCache.h"
+#include "mlConvertJournal.h"
+#include "mlConvertPlan.h"
+#include "mlConvertProgress.h"
+#include "mlExportValidator.h"
+#include "mlExportWatcher.h"
+#include "mlGovernor.h"
+#include "mlLogIndex.h"
+#include "mlLogParser.h"
+#include "mlLogView.h"
+#include "mlOutputSink.h"
+#include "mlProcess.h"
+#include "mlTaskManager.h"
 
 class mlMainWindow;
 class mlExport2BinWidget;